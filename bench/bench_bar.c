@@ -0,0 +1,81 @@
+// End-to-end timing of one chart command.
+//
+//   bench_bar "bar file='data.csv' x='department' y='salary' compute='sum'"
+//
+// The chart itself goes to /dev/null; one summary line with rows/sec, MB/sec
+// and peak RSS goes to stdout.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include "../headers/mathigraphs.h"
+
+// Helper: data rows in a file (newlines minus the header), not timed
+static long count_rows(const char *path)
+{
+    FILE *fp = fopen(path, "r");
+    if (!fp) return -1;
+    static char buf[1 << 16];
+    long lines = 0;
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+        for (size_t i = 0; i < n; i++)
+            if (buf[i] == '\n') lines++;
+    fclose(fp);
+    return lines > 0 ? lines - 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s \"bar file='...' x='...' y='...'\"\n", argv[0]);
+        return 1;
+    }
+
+    char *command = strdup(argv[1]);
+    char *file = get_option_value(command, "file=");
+    if (!file)
+    {
+        fprintf(stderr, "bench_bar: command has no file= option\n");
+        return 1;
+    }
+    long rows = count_rows(file);
+    long bytes = mathi_file_size(file);
+    if (rows < 0 || bytes < 0)
+    {
+        fprintf(stderr, "bench_bar: cannot read %s\n", file);
+        return 1;
+    }
+
+    // silence the chart, keep a handle on the real stdout for the summary
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    int devnull = open("/dev/null", O_WRONLY);
+    dup2(devnull, STDOUT_FILENO);
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if (strncmp(command, "hist", 4) == 0) display_hist(command);
+    else display_bar(command);
+    fflush(stdout);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    dup2(saved, STDOUT_FILENO);
+    close(devnull);
+    close(saved);
+
+    double secs = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+
+    printf("%-40s rows=%-10ld size=%8.1fMB time=%8.3fs rows/s=%12.0f MB/s=%8.1f peak_rss=%8.1fMB\n",
+           file, rows, bytes / 1e6, secs, rows / secs, bytes / 1e6 / secs, ru.ru_maxrss / 1024.0);
+
+    free(file);
+    free(command);
+    return 0;
+}
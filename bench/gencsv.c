@@ -0,0 +1,86 @@
+// Deterministic company.csv-shaped data generator for benchmarks.
+//
+//   gencsv ROWS [CARDINALITY] [SKEW] [SEED] > file.csv
+//
+// Columns are year,name,department,role,salary. The department column is the
+// benchmark's X column: CARDINALITY distinct values drawn from a Zipf
+// distribution with exponent SKEW (0 = uniform). The same arguments always
+// produce the same file.
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+static unsigned long long rng_state;
+
+// xorshift64*: fast, and identical on every platform
+static unsigned long long rng_next(void)
+{
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+static double rng_unit(void)
+{
+    return (rng_next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Helper: smallest index whose cumulative weight reaches u
+static long pick(const double *cdf, long n, double u)
+{
+    long lo = 0, hi = n - 1;
+    while (lo < hi)
+    {
+        long mid = (lo + hi) / 2;
+        if (cdf[mid] < u) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s ROWS [CARDINALITY] [SKEW] [SEED]\n", argv[0]);
+        return 1;
+    }
+    long rows = atol(argv[1]);
+    long card = argc > 2 ? atol(argv[2]) : 100;
+    double skew = argc > 3 ? atof(argv[3]) : 1.0;
+    rng_state = argc > 4 ? strtoull(argv[4], NULL, 10) : 42;
+    if (rows < 0 || card < 1 || skew < 0 || rng_state == 0)
+    {
+        fprintf(stderr, "gencsv: invalid arguments\n");
+        return 1;
+    }
+
+    // Zipf weights 1/k^skew, normalised into a CDF
+    double *cdf = malloc(card * sizeof(double));
+    if (!cdf) { fprintf(stderr, "gencsv: out of memory\n"); return 1; }
+    double total = 0;
+    for (long k = 0; k < card; k++)
+    {
+        total += 1.0 / pow((double)(k + 1), skew);
+        cdf[k] = total;
+    }
+    for (long k = 0; k < card; k++) cdf[k] /= total;
+
+    static const char *roles[] = {"Engineer", "Analyst", "Manager", "Specialist", "Director", "Intern"};
+    static char buf[1 << 16];
+    setvbuf(stdout, buf, _IOFBF, sizeof(buf));
+
+    printf("year,name,department,role,salary\n");
+    for (long i = 0; i < rows; i++)
+    {
+        long dept = pick(cdf, card, rng_unit());
+        printf("%ld,Employee %ld,Dept %05ld,%s,%ld\n",
+               2000 + (long)(rng_next() % 26), i, dept,
+               roles[rng_next() % (sizeof(roles) / sizeof(roles[0]))],
+               30000 + (long)(rng_next() % 90000));
+    }
+
+    free(cdf);
+    return 0;
+}
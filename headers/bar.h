@@ -3,23 +3,66 @@
 
 typedef struct {
     char *file;
+    char *data;
     char *x;
     char *y;
     char *title;
     char *compute;
     char *sort;
+    char *bucket;
+    char *profile;
+    char *format;
+    char *where;
+    char *mem_limit;
+    char *presorted;
+    char *sample;
+    char *sample_rows;
+    char *progress;
+    char *join;
+    char *on;
+    char *window;
+    char *cube;
 } BarOptions;
 
 typedef struct {
-    char *label;
-    double sum;
-    int count;
-    double min;
-    double max;
-} Group;
+    int colX;
+    int colY;
+    long long width;   // bucket width in seconds, 0 without bucket
+    long long limit;   // group table budget in bytes, 0 for no limit
+    int presorted;     // X order: 1 stated, 0 not sorted, -1 detect
+    double fraction;   // sample= chance of each row being read, 0 for all rows
+    int sampleRows;    // sample_rows= reservoir size, 0 for none
+    WindowSpec window; // window= over the groups in X order, all 0 for none
+    Where where;
+} BarPlan;
+
+// How the rows of a sampled query were drawn, to scale its estimates
+typedef struct {
+    double fraction;   // chance of each row being in the sample
+    long rows;         // rows in the sample
+    int reservoir;     // sample_rows=: fraction is exact, not a design chance
+} BarSample;
 
 void display_bar(char *command);
 
-void draw_bar(const BarOptions *opts);
+void bar_options(const char *command, BarOptions *opts);
+
+int bar_validate(const BarOptions *opts);
+
+void free_bar_options(BarOptions *opts);
+
+int bar_plan(const BarOptions *opts, char **header, int ncols, BarPlan *plan);
+
+void bar_plan_free(BarPlan *plan);
+
+void run_bar(const BarOptions *opts, const BarPlan *plan);
+
+void draw_bar(const BarOptions *opts, const BarPlan *plan, QueryStats *stats);
+
+void finish_bar(const BarOptions *opts, Group *groups, int gcount, const BarSample *sample, QueryStats *stats);
+
+void render_bars(const char *title, char **labels, const double *values, const double *errs, int count);
+
+char* get_option_value(const char *command, const char *key);
 
 #endif
\ No newline at end of file
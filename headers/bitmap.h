@@ -0,0 +1,54 @@
+#ifndef BITMAP_H
+#define BITMAP_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// A chunk holds the values sharing their high 16 bits: up to
+// BITMAP_ARRAY_MAX of them as a sorted array of the low 16 bits, more as a
+// 65536-bit bitmap of BITMAP_WORDS words
+#define BITMAP_ARRAY_MAX 4096
+#define BITMAP_WORDS 1024
+
+typedef struct {
+    uint16_t key;       // high 16 bits of its values
+    uint32_t card;      // values held
+    uint32_t cap;       // array room
+    uint16_t *array;    // sorted low bits, NULL once a bitmap
+    uint64_t *words;    // the bitmap, NULL while an array
+} BitmapChunk;
+
+// A compressed set of 32-bit ids (the roaring layout): chunks by ascending
+// key, each an array or a bitmap, whichever is smaller
+typedef struct {
+    BitmapChunk *chunks;
+    int nchunks;
+    int cap;
+} Bitmap;
+
+// Walks the ids of a bitmap in ascending order
+typedef struct {
+    const Bitmap *b;
+    int chunk;
+    uint32_t pos;       // array index, or bit index in a bitmap chunk
+} BitmapIter;
+
+int bitmap_append(Bitmap *b, uint32_t id);
+
+void bitmap_trim(Bitmap *b);
+
+int bitmap_and(const Bitmap *a, const Bitmap *b, Bitmap *out);
+
+int bitmap_or(const Bitmap *a, const Bitmap *b, Bitmap *out);
+
+long bitmap_count(const Bitmap *b);
+
+size_t bitmap_bytes(const Bitmap *b);
+
+void bitmap_iter(BitmapIter *it, const Bitmap *b);
+
+long bitmap_next(BitmapIter *it);
+
+void bitmap_free(Bitmap *b);
+
+#endif
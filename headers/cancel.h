@@ -0,0 +1,13 @@
+#ifndef CANCEL_H
+#define CANCEL_H
+
+// Rows between cancellation checks in loops that do not go through csv_next
+#define CANCEL_CHECK_ROWS 65536
+
+void cancel_install(void);
+
+int cancel_requested(void);
+
+void cancel_clear(void);
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef COMMAND_H
+#define COMMAND_H
+
+int run_command(char *line);
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef CSV_H
+#define CSV_H
+
+#include <stdio.h>
+
+typedef struct {
+    FILE *fp;
+    char **header;  // lowercased, trimmed column names
+    int ncols;
+    char *line;     // current record (owned, grows as needed)
+    size_t cap;
+    size_t len;
+    char *extra;    // continuation line of a multi-line quoted record
+    size_t extra_cap;
+    char **fields;  // pointers into line, unquoted, valid until the next csv_next
+    int nfields;
+    int fcap;
+    long rows;      // data rows returned so far (header excluded)
+    long bytes;     // bytes consumed so far
+} CsvReader;
+
+typedef struct {
+    long long size;
+    long long mtime_ns;
+} CsvFingerprint;
+
+int csv_open(CsvReader *r, const char *path);
+
+void csv_open_error(int rc, const char *path);
+
+int csv_open_file(CsvReader *r, const char *path);
+
+int csv_read_header(CsvReader *r);
+
+int csv_next(CsvReader *r);
+
+int csv_skip(CsvReader *r);
+
+int csv_seek_record(CsvReader *r, long long offset, long long *pos);
+
+int csv_find_column(const CsvReader *r, const char *name);
+
+int csv_number(const char *s, double *out);
+
+int csv_label_order(const char *a, const char *b);
+
+int csv_rewind(CsvReader *r);
+
+void csv_close(CsvReader *r);
+
+int csv_fingerprint(const char *path, CsvFingerprint *fp);
+
+int csv_same_file(const CsvFingerprint *a, const CsvFingerprint *b);
+
+#endif
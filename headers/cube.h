@@ -0,0 +1,23 @@
+#ifndef CUBE_H
+#define CUBE_H
+
+// Dimensions a rollup may name, and dimensions per combination
+#define CUBE_MAX_DIMS 8
+#define CUBE_MAX_DEPTH 3
+
+// Distinct values per dimension; three codes pack into one 64-bit key
+#define CUBE_CODE_BITS 21
+#define CUBE_MAX_CODES ((1 << CUBE_CODE_BITS) - 1)
+
+typedef struct {
+    char *file;
+    char *dims;
+    char *y;
+    char *depth;
+} RollupOptions;
+
+void display_rollup(char *command);
+
+int cube_query(const char *file, const char *x, const char *y, const char *where, Group **out, long long *bytes);
+
+#endif
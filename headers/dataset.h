@@ -0,0 +1,73 @@
+#ifndef DATASET_H
+#define DATASET_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Distinct values a column may have and still get a bitmap index
+#define DATASET_INDEX_MAX_VALUES 256
+
+typedef enum {
+    COLUMN_NUMBER,
+    COLUMN_TEXT,
+    COLUMN_INT,
+    COLUMN_DATE
+} ColumnType;
+
+// The rows of each distinct value of a column, as one bitmap per value
+typedef struct {
+    uint32_t nvalues;
+    long *rowOf;       // a row holding each value, to test filter terms on
+    Bitmap *rows;      // rows holding each value
+} ColumnIndex;
+
+typedef struct {
+    char *name;        // lowercased header name
+    ColumnType type;   // from the file's schema, see schema_get
+    double *num;       // COLUMN_NUMBER: values, NAN where empty
+    int32_t *ints;     // COLUMN_INT: values, COLUMN_DATE: days since 1970,
+                       // SCHEMA_MISSING where empty
+    uint32_t *codes;   // COLUMN_TEXT: per row, an index into dict
+    char **dict;       // COLUMN_TEXT: distinct values in order of first
+    uint32_t ndict;    // appearance, pointing into the dataset arena
+    ColumnIndex *index; // text, integer and date columns with at most
+                        // DATASET_INDEX_MAX_VALUES values, NULL otherwise
+} Column;
+
+typedef struct Dataset {
+    struct Dataset *next;
+    char *name;
+    char *file;
+    Column *cols;
+    char **header;     // column names, for lookups shared with CSV files
+    int ncols;
+    long nrows;
+    char *arena;       // distinct values of all COLUMN_TEXT columns
+    size_t bytes;      // memory held by columns and arena
+    int refs;          // registry link plus running queries
+} Dataset;
+
+typedef struct {
+    char *name;
+    char *file;
+} LoadOptions;
+
+void display_load(char *command);
+
+void display_unload(char *command);
+
+void display_datasets(void);
+
+Dataset *dataset_acquire(const char *name);
+
+void dataset_release(Dataset *ds);
+
+int dataset_find_column(const Dataset *ds, const char *name);
+
+const char *dataset_text(const Dataset *ds, int col, long row, char *buf, size_t size);
+
+int dataset_number(const Dataset *ds, int col, long row, double *out);
+
+unsigned long hash_text(const char *s);
+
+#endif
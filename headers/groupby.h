@@ -0,0 +1,98 @@
+#ifndef GROUPBY_H
+#define GROUPBY_H
+
+#include <stdio.h>
+
+// Spill files per level; level d partitions on hash bits 60-4d..63-4d
+#define SPILL_PARTITIONS 16
+#define SPILL_MAX_DEPTH 4
+
+typedef struct {
+    char *label;
+    double sum;
+    double sumsq;       // sum of squares, for the spread of sampled groups
+    int count;
+    double min;
+    double max;
+    long first;         // row the label first appeared on, kept by group_merge
+} Group;
+
+// Groups keyed by label: an open-addressing table of indexes into groups
+typedef struct {
+    Group *groups;
+    int gcount;
+    int gcap;
+    int *table;         // group index per slot, -1 when empty
+    size_t tcap;        // a power of two, kept at least twice gcount
+    long long bytes;    // heap held by groups, labels and table (estimate)
+} GroupTable;
+
+// Receives the groups of one finished spill partition
+typedef int (*GroupSink)(Group *groups, int gcount, void *ctx);
+
+// Temporary partition files holding partial groups as (label, group) records
+typedef struct {
+    FILE *part[SPILL_PARTITIONS];
+    int depth;
+    long long bytes;    // bytes written, this level and below
+} Spill;
+
+// One finished result: a group's label and its computed value
+typedef struct {
+    const char *label;
+    double value;
+    long first;         // the group's first row, orders results and ties
+} GroupResult;
+
+typedef enum {
+    RUNS_BY_FIRST,      // first-seen order, as an in-memory group-by gives
+    RUNS_BY_VALUE,      // descending
+    RUNS_BY_LABEL
+} RunsOrder;
+
+// Results of a spilled group-by, written to disk one run per partition
+typedef struct {
+    FILE *file;         // every run, one after another
+    long *starts;       // file offset of each run
+    int nruns;
+    int runcap;
+    RunsOrder order;    // each run is sorted by this
+    long count;         // results in all runs
+    double maxValue;
+    int maxLabel;       // longest label in bytes
+    long long bytes;    // bytes written
+} GroupRuns;
+
+void group_add(Group *g, double val);
+
+void group_merge(Group *g, const Group *part);
+
+void groups_free(Group *groups, int gcount);
+
+Group *group_table_get(GroupTable *t, const char *label);
+
+Group *group_table_append(GroupTable *t, const char *label);
+
+void group_table_free(GroupTable *t);
+
+int group_limit(const char *spec, long long *bytes);
+
+int spill_open(Spill *s, int depth);
+
+int spill_write(Spill *s, const char *label, const Group *g);
+
+int spill_table(Spill *s, GroupTable *t);
+
+int spill_aggregate(Spill *s, long long limit, GroupSink sink, void *ctx);
+
+void spill_close(Spill *s);
+
+int runs_open(GroupRuns *r, RunsOrder order);
+
+int runs_add(GroupRuns *r, GroupResult *items, int n);
+
+int runs_each(GroupRuns *r, int (*emit)(const GroupResult *item, void *ctx), void *ctx);
+
+void runs_close(GroupRuns *r);
+
+#endif
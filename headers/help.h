@@ -2,6 +2,13 @@
 #define HELP_H
 
 void bar_help();
+void hist_help();
+void line_help();
+void scatter_help();
+void pivot_help();
+void rollup_help();
+void dataset_help();
+void prepare_help();
 
 
 #endif
\ No newline at end of file
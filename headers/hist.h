@@ -0,0 +1,17 @@
+#ifndef HIST_H
+#define HIST_H
+
+typedef struct {
+    char *file;
+    char *col;
+    char *bins;
+    char *min;
+    char *max;
+    char *title;
+} HistOptions;
+
+void display_hist(char *command);
+
+void draw_hist(const HistOptions *opts);
+
+#endif
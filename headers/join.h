@@ -0,0 +1,49 @@
+#ifndef JOIN_H
+#define JOIN_H
+
+// The rows of a bar query's file joined with a second file on a key column.
+// The smaller file is read into a hash table (the build side); the other is
+// streamed past it one row at a time (the probe side). Joined rows hold the
+// main file's columns, then the joined file's.
+typedef struct {
+    CsvReader *main;    // the query's file, header already read
+    CsvReader other;    // the joined file
+    CsvReader *probe;   // the side streamed row by row
+    CsvReader *build;   // the side held in the hash table
+    int keyProbe;       // key column on each side
+    int keyBuild;
+    int probeBase;      // first column of each side in fields
+    int buildBase;
+    int ncols;
+    char **header;      // main columns then joined columns (main names win)
+    char **fields;      // the current joined row
+
+    // build rows: the key, then every cell (padded to the header), as
+    // NUL-separated strings in one arena
+    char *arena;
+    size_t len;
+    size_t cap;
+    size_t *rows;       // arena offset of each build row
+    long nrows;
+    long rcap;
+    long *next;         // next build row with the same key, -1 at the end
+    long *table;        // open addressing: first build row of a key, -1 for empty
+    size_t tcap;
+    long keys;
+    char *hit;          // build rows joined at least once
+
+    long match;         // build row to join with the current probe row, -1 for none
+    long unmatched;     // probe rows without a partner
+} Join;
+
+int join_open(Join *j, CsvReader *main, const char *mainFile, const char *file, const char *key);
+
+int join_build(Join *j);
+
+int join_next(Join *j);
+
+long join_unmatched(const Join *j);
+
+void join_close(Join *j);
+
+#endif
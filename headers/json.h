@@ -0,0 +1,14 @@
+#ifndef JSON_H
+#define JSON_H
+
+void json_print(const MathiJSON *value);
+
+void json_write(const MathiJSON *value);
+
+void json_write_members(const MathiJSON *obj);
+
+void json_write_string(const char *s);
+
+void json_write_number(double d);
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef LINE_H
+#define LINE_H
+
+typedef struct {
+    char *file;
+    char *x;
+    char *y;
+    char *title;
+    char *width;
+    char *height;
+    char *window;
+    char *compute;
+} LineOptions;
+
+typedef struct {
+    double x;
+    double y;
+} Point;
+
+void display_line(char *command);
+
+void draw_line(const LineOptions *opts);
+
+#endif
@@ -4,6 +4,31 @@
 #include "../mathi.h"
 #include "starter.h"
 #include "help.h"
+#include "json.h"
+#include "memtrack.h"
+#include "cancel.h"
+#include "progress.h"
+#include "stats.h"
+#include "csv.h"
+#include "term.h"
+#include "timestamp.h"
+#include "schema.h"
+#include "bitmap.h"
+#include "dataset.h"
+#include "groupby.h"
+#include "sample.h"
+#include "window.h"
+#include "where.h"
+#include "join.h"
+#include "cube.h"
 #include "bar.h"
+#include "prepare.h"
+#include "hist.h"
+#include "pivot.h"
+#include "line.h"
+#include "scatter.h"
+#include "command.h"
+#include "server.h"
+#include "output.h"
 
 #endif
@@ -0,0 +1,21 @@
+#ifndef MEMTRACK_H
+#define MEMTRACK_H
+
+typedef struct {
+    long allocs;        // malloc/calloc/realloc calls that returned memory
+    long frees;         // free calls on a non-null pointer
+    long long in_use;   // bytes allocated minus bytes freed since the reset
+    long long peak;     // high-water mark of in_use since the reset
+} MemStats;
+
+void mem_tracking(int on);
+
+int mem_tracking_enabled(void);
+
+void mem_reset(void);
+
+void mem_snapshot(MemStats *m);
+
+void mem_report(const MemStats *m);
+
+#endif
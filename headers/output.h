@@ -0,0 +1,17 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stdio.h>
+
+// Command output goes to the calling thread's stream: stdout, unless the
+// thread has captured it (server workers do). Modules print through these
+// helpers, or to output_stream() for the other stdio calls, never to stdout.
+FILE *output_stream(void);
+
+void output_capture(FILE *stream);
+
+int out_printf(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+int out_putchar(int c);
+
+#endif
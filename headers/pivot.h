@@ -0,0 +1,23 @@
+#ifndef PIVOT_H
+#define PIVOT_H
+
+// Cells a pivot may hold (distinct rows x distinct cols)
+#define PIVOT_MAX_CELLS (1 << 20)
+
+typedef struct {
+    char *file;
+    char *data;
+    char *rows;
+    char *cols;
+    char *val;
+    char *compute;
+    char *where;
+    char *style;
+    char *title;
+} PivotOptions;
+
+void display_pivot(char *command);
+
+void draw_pivot(const PivotOptions *opts);
+
+#endif
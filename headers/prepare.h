@@ -0,0 +1,19 @@
+#ifndef PREPARE_H
+#define PREPARE_H
+
+typedef struct Prepared {
+    struct Prepared *next;
+    char *name;
+    BarOptions opts;        // parsed and validated once
+    char **header;          // header of opts.file when prepared (file queries)
+    int ncols;
+    CsvFingerprint fp;      // the file the header was read from
+    BarPlan plan;           // columns and filter resolved against header
+    int refs;               // registry link plus running queries
+} Prepared;
+
+void display_prepare(char *command);
+
+void display_run(char *command);
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+// Rows between clock reads while a scan shows progress
+#define PROGRESS_CHECK_ROWS 4096
+
+// A new frame is drawn this often, or after this many bytes, whichever first
+#define PROGRESS_INTERVAL_NS 250000000LL
+#define PROGRESS_BYTES (64L * 1024 * 1024)
+
+// Partial results redrawn in place while a long scan runs
+typedef struct {
+    long long start;    // stats_wall_ns when the scan started
+    long long last;     // when the last frame was drawn
+    long lastBytes;
+    long ticks;
+    int lines;          // lines the frame on screen takes
+} Progress;
+
+int progress_wanted(const char *option);
+
+void progress_start(Progress *p);
+
+int progress_due(Progress *p, long bytes);
+
+void progress_erase(Progress *p);
+
+void progress_status(Progress *p, double done, long rows);
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef SAMPLE_H
+#define SAMPLE_H
+
+// Files are sampled by blocks of this size when enough blocks would be read
+#define SAMPLE_BLOCK_SIZE (16 * 1024)
+#define SAMPLE_MIN_BLOCKS 32
+
+// z for the two-sided 95% confidence intervals shown with sampled results
+#define SAMPLE_Z 1.96
+
+typedef struct {
+    unsigned long long state;
+} SampleRng;
+
+// Reservoir of k items over a stream of unknown length (Algorithm L)
+typedef struct {
+    long k;
+    long seen;      // stream items offered so far
+    long next;      // stream index of the next item that gets a slot
+    double w;
+} Reservoir;
+
+void sample_seed(SampleRng *rng);
+
+double sample_uniform(SampleRng *rng);
+
+long sample_gap(SampleRng *rng, double p);
+
+void reservoir_init(Reservoir *r, long k);
+
+long reservoir_slot(Reservoir *r, SampleRng *rng);
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef SCATTER_H
+#define SCATTER_H
+
+typedef struct {
+    char *file;
+    char *x;
+    char *y;
+    char *title;
+    char *width;
+    char *height;
+    char *style;
+    char *xmin;
+    char *xmax;
+    char *ymin;
+    char *ymax;
+} ScatterOptions;
+
+void display_scatter(char *command);
+
+void draw_scatter(const ScatterOptions *opts);
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef SCHEMA_H
+#define SCHEMA_H
+
+#include <stdint.h>
+
+// Rows read from the top of a file to infer its column types
+#define SCHEMA_SAMPLE_ROWS 1000
+
+// Empty cells of typed int32 columns (integers and dates)
+#define SCHEMA_MISSING INT32_MIN
+
+typedef enum {
+    SCHEMA_EMPTY,      // no value seen yet; only while sniffing
+    SCHEMA_INT64,
+    SCHEMA_DOUBLE,
+    SCHEMA_DATE,       // YYYY-MM-DD without a time
+    SCHEMA_TEXT
+} SchemaType;
+
+int schema_get(const char *file, SchemaType *types, int ncols);
+
+void schema_update(const char *file, const SchemaType *types, int ncols);
+
+SchemaType schema_cell(const char *s);
+
+SchemaType schema_merge(SchemaType a, SchemaType b);
+
+const char *schema_type_name(SchemaType t);
+
+int schema_int(const char *s, long long *out);
+
+int schema_double(const char *s, double *out);
+
+int schema_date(const char *s, int32_t *days);
+
+int schema_number(SchemaType t, const char *s, double *out);
+
+void display_schema(char *command);
+
+#endif
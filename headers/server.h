@@ -0,0 +1,6 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+int serve_mathigraphs(const char *address, int workers);
+
+#endif
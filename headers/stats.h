@@ -0,0 +1,48 @@
+#ifndef STATS_H
+#define STATS_H
+
+typedef enum {
+    STAGE_OPEN,
+    STAGE_HEADER,
+    STAGE_PARSE,
+    STAGE_AGGREGATE,
+    STAGE_SORT,
+    STAGE_RENDER,
+    STAGE_COUNT,
+    STAGE_NONE = -1
+} QueryStage;
+
+typedef struct {
+    int timing;                       // read the clocks only when profiling
+    int stage;                        // running stage or STAGE_NONE
+    long long wall_start;
+    long long cpu_start;
+    long long wall_ns[STAGE_COUNT];   // monotonic wall time per stage
+    long long cpu_ns[STAGE_COUNT];    // thread CPU time per stage
+    long rows[STAGE_COUNT];
+    long bytes[STAGE_COUNT];
+    long rows_scanned;                // data rows read from the file
+    long rows_rejected;               // rows skipped: short, non-numeric or bad time
+    long groups;                      // groups in the result
+    long bytes_read;                  // file bytes read, header included
+    long cache_hits;                  // results answered without reading the file
+    long long spill_bytes;            // bytes written to group-by spill files
+} QueryStats;
+
+long long stats_wall_ns(void);
+
+long long stats_cpu_ns(void);
+
+void stats_init(QueryStats *s, int timing);
+
+void stats_stage(QueryStats *s, QueryStage next);
+
+void stats_count(QueryStats *s, QueryStage stage, long rows, long bytes);
+
+void stats_report(const QueryStats *s);
+
+MathiJSON *stats_json(const QueryStats *s);
+
+int option_enabled(const char *value);
+
+#endif
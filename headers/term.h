@@ -0,0 +1,8 @@
+#ifndef TERM_H
+#define TERM_H
+
+void term_size(int *cols, int *rows);
+
+int term_option(const char *value, int fallback, int min, int max);
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef TIMESTAMP_H
+#define TIMESTAMP_H
+
+#include <stddef.h>
+
+int ts_parse(const char *s, long long *out);
+
+int ts_bucket_width(const char *spec, long long *seconds);
+
+long long ts_bucket_index(long long t, long long width);
+
+long long ts_bucket_start(long long index, long long width);
+
+void ts_format(long long t, long long width, char *buf, size_t size);
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef WHERE_H
+#define WHERE_H
+
+typedef enum {
+    WHERE_EQ,
+    WHERE_NE,
+    WHERE_LT,
+    WHERE_LE,
+    WHERE_GT,
+    WHERE_GE
+} WhereOp;
+
+typedef struct {
+    char *column;      // lowercased column name
+    int col;           // index once bound, -1 before
+    WhereOp op;
+    char *text;        // the literal as written
+    double num;        // the literal as a number, when isNumber
+    int isNumber;
+} WhereTerm;
+
+// A filter in disjunctive normal form: terms joined by 'and' form a clause,
+// clauses are joined by 'or'. clauseEnd[i] is one past the last term of
+// clause i. An empty filter (nclauses 0) matches every row.
+typedef struct {
+    WhereTerm *terms;
+    int nterms;
+    int *clauseEnd;
+    int nclauses;
+} Where;
+
+// Walks the dataset rows that pass a filter. When every clause has a term
+// on an indexed column, only the rows the indexes leave are visited.
+typedef struct {
+    const Where *w;
+    const Dataset *ds;
+    int indexed;       // rows come from matches
+    int exact;         // ...and all pass, no term needs checking per row
+    Bitmap matches;
+    BitmapIter it;
+    long row;          // next row to look at, without an index
+    long visited;      // rows looked at so far
+} WhereScan;
+
+int where_parse(const char *expr, Where *w);
+
+int where_bind(Where *w, char **names, int ncols);
+
+int where_match(const Where *w, char **fields, int nfields);
+
+int where_match_row(const Where *w, const Dataset *ds, long row);
+
+void where_scan_start(WhereScan *s, const Where *w, const Dataset *ds);
+
+long where_scan_next(WhereScan *s);
+
+void where_scan_end(WhereScan *s);
+
+void where_free(Where *w);
+
+#endif
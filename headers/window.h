@@ -0,0 +1,59 @@
+#ifndef WINDOW_H
+#define WINDOW_H
+
+// A window= option: the last N points, or the points less than a span
+// behind the newest one (in x units: seconds for times)
+typedef struct {
+    long count;         // window=N, 0 for a span
+    long long span;     // window='7d' in seconds, 0 for a count
+} WindowSpec;
+
+// One point of a rolling window; a point may carry a whole group
+typedef struct {
+    double x;
+    double sum;
+    double sumsq;
+    long count;
+    double min;
+    double max;
+    long seq;           // place in the stream
+} WindowEntry;
+
+// The aggregates of the points in a window, updated in O(1) amortized per
+// point: entries in a ring buffer with running sums (subtracted as points
+// leave), and for min and max monotonic deques of the entries that can
+// still be the answer, so a new point drops the ones it beats.
+typedef struct {
+    WindowSpec spec;
+    WindowEntry *ring;
+    long cap;
+    long head;          // oldest entry
+    long size;
+    long seq;           // points pushed so far
+    long evicted;       // points dropped since the sums were last recomputed
+    double sum;
+    double sumsq;
+    long count;
+    WindowEntry *mins;  // deques of ring copies, ascending mins...
+    WindowEntry *maxs;  // ...and descending maxes
+    long minHead, minSize;
+    long maxHead, maxSize;
+} Rolling;
+
+int window_parse(const char *spec, WindowSpec *w);
+
+int rolling_init(Rolling *r, const WindowSpec *spec);
+
+int rolling_push(Rolling *r, const WindowEntry *e);
+
+double rolling_min(const Rolling *r);
+
+double rolling_max(const Rolling *r);
+
+double rolling_value(const Rolling *r, const char *compute);
+
+void rolling_reset(Rolling *r);
+
+void rolling_free(Rolling *r);
+
+#endif
@@ -11,6 +11,9 @@ void start_mathigraphs()
 	// opening remarks
 	starter();
 
+	// Ctrl-C cancels the running command instead of the session
+	cancel_install();
+
 	// loop wrapper
 	while(1)
 	{
@@ -25,34 +28,35 @@ void start_mathigraphs()
 			continue;
 		}
 
-		// validate the input // from mathi c library
-		char *user_inp = mathi_string_to_lower((char*)inp.value);
-		if (mathi_string_compare(user_inp, "help") == 0)
-		{
-			bar_help();
-		}
-		else if(mathi_string_compare(user_inp, "exit") == 0)
+		// run it // lowercased by run_command
+		if(run_command((char*)inp.value))
 		{
-			printf("Bye!\n");
 			break;
 		}
-		else if (strncmp(user_inp, "bar", 3) == 0) // supports bar only for now
-		{
-			display_bar(user_inp);
-		}
-		else
-		{
-			printf("Invalid command. Type help to see commands\n");
-		}
 
 		// new lines
 		printf("\n");
 	}
 }
 
-// int main()
-// {
-	
-// 	start_mathigraphs();
-// 	return 0;
-// }
\ No newline at end of file
+int main(int argc, char **argv)
+{
+	// mathigraphs --serve [host:]port [--workers N]
+	if(argc >= 2 && strcmp(argv[1], "--serve") == 0)
+	{
+		int workers = 0;
+		if(argc == 5 && strcmp(argv[3], "--workers") == 0 && mathi_str_to_int(argv[4], &workers) == 0 && workers > 0)
+		{
+			return serve_mathigraphs(argv[2], workers) == 0 ? 0 : 1;
+		}
+		if(argc != 3)
+		{
+			printf("Usage: mathigraphs --serve [host:]port [--workers N]\n");
+			return 1;
+		}
+		return serve_mathigraphs(argv[2], workers) == 0 ? 0 : 1;
+	}
+
+	start_mathigraphs();
+	return 0;
+}
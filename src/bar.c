@@ -5,33 +5,38 @@
 #include "../headers/mathigraphs.h"
 
 #define MAX_BAR_WIDTH 50
-
-// Helper: trim whitespace
-static void trim(char *s) {
-    char *end;
-    while (*s == ' ' || *s == '\t') s++;  // leading
-    if (*s == 0) return;
-    end = s + strlen(s) - 1;
-    while (end > s && (*end == ' ' || *end == '\n' || *end == '\r')) *end-- = '\0';
-}
+#define MIN_LABEL_WIDTH 15
+#define MAX_LABEL_WIDTH 32
+#define MAX_TIME_BUCKETS (1 << 20)
 
 // Helper: repeat character
 static void repeat_char(char c, int count) {
-    for (int i = 0; i < count; i++) putchar(c);
+    for (int i = 0; i < count; i++) out_putchar(c);
 }
 
 // Get option value from command
+// Accepts key='quoted value' or key=bare_value; the key must start a word
 char* get_option_value(const char *command, const char *key) 
 {
-    char *pos = strstr(command, key);
+    const char *pos = strstr(command, key);
+    while (pos && pos != command && pos[-1] != ' ' && pos[-1] != '\t')
+        pos = strstr(pos + 1, key);
     if (!pos) return NULL;
 
-    pos += strlen(key); // next should be '
-    if (*pos != '\'') return NULL; // next not '
-    pos++; // ahead of '
-
-    char *end = strchr(pos, '\''); // start from ahead '
-    if (!end) return NULL;
+    pos += strlen(key);
+    const char *end;
+    if (*pos == '\'') // quoted value
+    {
+        pos++; // ahead of '
+        end = strchr(pos, '\''); // start from ahead '
+        if (!end) return NULL;
+    }
+    else // bare value runs to the next blank
+    {
+        end = pos;
+        while (*end && *end != ' ' && *end != '\t' && *end != '\n') end++;
+        if (end == pos) return NULL;
+    }
 
     size_t len = end - pos;
     char *value = malloc(len + 1);
@@ -41,243 +46,1504 @@ char* get_option_value(const char *command, const char *key)
     return value;
 }
 
-// Draw bar graph
-void draw_bar(const BarOptions *opts) 
+// Helper: label column width for the longest label
+static int label_width(int longest)
+{
+    if (longest < MIN_LABEL_WIDTH) return MIN_LABEL_WIDTH;
+    return longest > MAX_LABEL_WIDTH ? MAX_LABEL_WIDTH : longest;
+}
+
+// Helper: draw one bar, scaled to the largest value; err is the half-width
+// of a confidence interval, NAN for an exact value
+static void render_bar_row(const char *label, double value, double err, double maxVal, int labelWidth)
+{
+    int barLen=maxVal>0 ? (int)((value/maxVal)*MAX_BAR_WIDTH) : 0;
+    out_printf("%-*.*s | ", labelWidth, labelWidth, label);
+    repeat_char('#', barLen);
+    if (isnan(err)) out_printf(" (%.2f)\n", value);
+    else out_printf(" (%.2f ± %.2f)\n", value, err);
+}
+
+// Render labelled values as horizontal bars scaled to the largest value.
+// errs, when given, holds a confidence interval half-width per value.
+void render_bars(const char *title, char **labels, const double *values, const double *errs, int count)
 {
-    FILE *fp = fopen(opts->file, "r");
-    if (!fp) 
+    double maxVal = -1e9;
+    int longest = 0;
+    for (int i = 0; i < count; i++)
     {
-        printf("Error: could not open file: %s\n", opts->file);
-        return;
+        if (values[i] > maxVal) maxVal = values[i];
+        int len = (int)strlen(labels[i]);
+        if (len > longest) longest = len;
     }
+    int labelWidth = label_width(longest);
+
+    // Print title
+    if (title) out_printf("\n%s\n\n", title);
+
+    // Draw bars
+    for(int i=0;i<count;i++) render_bar_row(labels[i], values[i], errs ? errs[i] : NAN, maxVal, labelWidth);
+    out_printf("\n");
+}
+
+enum { COMPUTE_AVG, COMPUTE_SUM, COMPUTE_MAX, COMPUTE_MIN };
+
+// Helper: the compute= method, -1 (with a message) when unknown
+static int bar_compute(const BarOptions *opts)
+{
+    if (!opts->compute || strcmp(opts->compute,"avg")==0) return COMPUTE_AVG;
+    if (strcmp(opts->compute,"sum")==0) return COMPUTE_SUM;
+    if (strcmp(opts->compute,"max")==0) return COMPUTE_MAX;
+    if (strcmp(opts->compute,"min")==0) return COMPUTE_MIN;
+    out_printf("Error: unknown compute '%s'.\n", opts->compute);
+    return -1;
+}
 
-    char line[1024];
-    if (!fgets(line, sizeof(line), fp)) 
+// Helper: the value a group shows for a compute method
+static double group_value(const Group *g, int compute)
+{
+    switch (compute)
     {
-        printf("Error: empty file\n");
-        fclose(fp);
-        return;
+        case COMPUTE_SUM: return g->sum;
+        case COMPUTE_MAX: return g->max;
+        case COMPUTE_MIN: return g->min;
+        default: return g->sum / g->count;
     }
+}
 
-    // Find X and Y column indexes
-    int colX_idx = -1, colY_idx = -1, idx = 0;
-    char *token = strtok(line, ",");
-    while (token) 
+// Helper: half-width of the 95% confidence interval of a group value from a
+// sample that kept each row with chance p, NAN where there is none. Sums are
+// scaled up by 1/p (Horvitz-Thompson), so their interval is too; min and max
+// of a sample have no such interval.
+static double group_interval(const Group *g, int compute, double p)
+{
+    if (compute == COMPUTE_SUM) return SAMPLE_Z * sqrt((1 - p) * g->sumsq) / p;
+    if (compute == COMPUTE_AVG && g->count > 1)
     {
-        trim(token);
-        char lower[128];
-        strncpy(lower, token, sizeof(lower)); lower[sizeof(lower)-1]=0;
-        mathi_string_to_lower(lower);
+        double var = (g->sumsq - g->sum * g->sum / g->count) / (g->count - 1);
+        return SAMPLE_Z * sqrt((var > 0 ? var : 0) * (1 - p) / g->count);
+    }
+    return NAN;
+}
 
-        if (strcmp(lower, opts->x) == 0) colX_idx = idx;
-        if (strcmp(lower, opts->y) == 0) colY_idx = idx;
+// Where a label group-by that outgrew mem_limit puts its results: computed
+// values in runs on disk, each run sorted the way sort= asks (by first row
+// without it, so the chart keeps the order an in-memory group-by gives)
+typedef struct {
+    GroupRuns runs;
+    int compute;
+} BarSpill;
 
-        idx++;
-        token = strtok(NULL, ",");
+// Helper: spill sink, turns one finished partition into a run of results
+static int spill_results(Group *groups, int gcount, void *ctx)
+{
+    BarSpill *bs = ctx;
+    GroupResult *items = malloc(gcount * sizeof(GroupResult));
+    if (!items) { out_printf("Error: out of memory\n"); return -1; }
+    for (int i = 0; i < gcount; i++)
+    {
+        items[i].label = groups[i].label;
+        items[i].value = group_value(&groups[i], bs->compute);
+        items[i].first = groups[i].first;
     }
+    int rc = runs_add(&bs->runs, items, gcount);
+    free(items);
+    return rc;
+}
+
+enum { SAMPLE_NONE, SAMPLE_ROWS, SAMPLE_BLOCKS, SAMPLE_RESERVOIR };
+
+// A row kept by sample_rows=
+typedef struct {
+    long order;     // place in the stream, to read the sample back in order
+    long row;       // dataset row
+    char *label;    // file row: its X cell, NULL when Y is not a number
+    double y;
+} SampleItem;
+
+// Rows for a bar query, from a CSV file or from a loaded dataset
+typedef struct {
+    CsvReader *csv;
+    Dataset *ds;
+    Join *join;             // join=: rows come joined, csv is the probe side
+    const Where *where;
+    WhereScan scan;         // dataset rows passing where, unless sampled by sample=
+    long row;
+    int colX;
+    int colY;
+    char buf[32];   // a numeric X cell formatted as a label
+    long long fileSize;
+    SchemaType typeY;       // file Y column type, picks the number parser
+    int compute;
+    Progress *progress;     // partial charts while scanning, NULL for none
+
+    // sample= and sample_rows=, see source_sample
+    int sample;
+    double fraction;        // chance of each row (or block) being read
+    SampleRng rng;
+    long gap;               // rows or blocks to pass before the next one read
+    long drawn;             // rows drawn into the sample
+    long block;             // block being read, of nblocks after the header
+    long nblocks;
+    long long dataStart;    // file offset of the first data row
+    long long blockEnd;
+    long long seekPos;      // file offset reached by the last seek...
+    long seekBytes;         // ...and csv->bytes at that moment
+    Reservoir res;
+    SampleItem *items;
+    long nitems;
+    long item;
+} BarSource;
 
-    if (colX_idx == -1 || colY_idx == -1) 
+// Helper: choose how a sample is drawn. sample_rows= keeps a reservoir.
+// sample= keeps each row with its chance, passing over the rows in between
+// without splitting them; on a file large enough to give SAMPLE_MIN_BLOCKS
+// blocks it picks whole blocks instead and seeks past the rest, so most of
+// the file is never read.
+static void source_sample(BarSource *src, const BarPlan *plan)
+{
+    sample_seed(&src->rng);
+    if (plan->sampleRows > 0)
     {
-        printf("Error: columns not found in header\n");
-        fclose(fp);
+        src->sample = SAMPLE_RESERVOIR;
+        reservoir_init(&src->res, plan->sampleRows);
         return;
     }
+    src->sample = SAMPLE_ROWS;
+    src->fraction = plan->fraction;
+    src->gap = sample_gap(&src->rng, src->fraction);
+    if (!src->csv) return;
 
-    // Read data and aggregate
-    Group groups[500];
+    src->dataStart = src->csv->bytes;
+    long long data = src->fileSize - src->dataStart;
+    long nblocks = (long)((data + SAMPLE_BLOCK_SIZE - 1) / SAMPLE_BLOCK_SIZE);
+    if (nblocks * src->fraction < SAMPLE_MIN_BLOCKS) return;
+    src->sample = SAMPLE_BLOCKS;
+    src->nblocks = nblocks;
+    src->block = -1;
+}
+
+// Helper: how far through its rows the source is, from 0 to 1
+static double source_done(const BarSource *src)
+{
+    if (src->ds) return src->ds->nrows ? (double)src->row / src->ds->nrows : 1;
+    if (src->sample == SAMPLE_RESERVOIR && src->nitems) return src->nitems ? (double)src->item / src->nitems : 1;
+    long long pos = src->csv->bytes;
+    if (src->sample == SAMPLE_BLOCKS && src->block >= 0) pos = src->seekPos + (src->csv->bytes - src->seekBytes);
+    return src->fileSize > 0 ? (double)pos / src->fileSize : -1;
+}
+
+// Helper: true when the scan should draw a progress frame now
+static int progress_tick(BarSource *src)
+{
+    return src->progress && progress_due(src->progress, src->csv ? src->csv->bytes : 0);
+}
+
+// Helper: the value a group shows so far; sampled sums are scaled by the
+// chance rows were drawn with until the real share is known
+static double progress_value(const BarSource *src, const Group *g)
+{
+    double v = group_value(g, src->compute);
+    if (src->sample && src->compute == COMPUTE_SUM && src->fraction > 0) v /= src->fraction;
+    return v;
+}
+
+// Helper: a slot's label: its own, from a dictionary, or its time bucket
+static const char *slot_label(const Group *slots, long i, char **dict, long long base, long long width, char *buf, size_t size)
+{
+    if (slots[i].label) return slots[i].label;
+    if (dict) return dict[i];
+    ts_format(ts_bucket_start(base + i, width), width, buf, size);
+    return buf;
+}
+
+// Helper: redraw the chart of the groups so far over the previous frame,
+// as many as fit the terminal, then the progress line. Slots with no rows
+// are skipped. Wrapped lines are counted so the next frame erases them all.
+static void draw_progress(BarSource *src, const Group *slots, long nslots, char **dict, long long base, long long width)
+{
+    Progress *p = src->progress;
+    int cols, rows;
+    term_size(&cols, &rows);
+    long room = rows > 5 ? rows - 4 : 1;
+
+    char buf[32];
+    double maxVal = -1e9;
+    int longest = 0;
+    long groups = 0;
+    for (long i = 0; i < nslots; i++)
+    {
+        if (slots[i].count == 0 || groups++ >= room) continue;
+        double v = progress_value(src, &slots[i]);
+        if (v > maxVal) maxVal = v;
+        int len = (int)strlen(slot_label(slots, i, dict, base, width, buf, sizeof(buf)));
+        if (len > longest) longest = len;
+    }
+    int labelWidth = label_width(longest);
+
+    progress_erase(p);
+    long shown = 0;
+    for (long i = 0; i < nslots && shown < groups && shown < room; i++)
+    {
+        if (slots[i].count == 0) continue;
+        double v = progress_value(src, &slots[i]);
+        render_bar_row(slot_label(slots, i, dict, base, width, buf, sizeof(buf)), v, NAN, maxVal, labelWidth);
+        int barLen = maxVal > 0 ? (int)((v / maxVal) * MAX_BAR_WIDTH) : 0;
+        int len = labelWidth + 3 + barLen + snprintf(NULL, 0, " (%.2f)", v);
+        p->lines += (len - 1) / cols + 1;
+        shown++;
+    }
+    if (groups > shown)
+    {
+        out_printf("... and %ld more groups\n", groups - shown);
+        p->lines++;
+    }
+    progress_status(p, source_done(src), src->csv ? src->csv->rows : src->row);
+}
+
+// Helper: order sampled items by their place in the stream
+static int item_order(const void *a, const void *b)
+{
+    long x = ((const SampleItem *)a)->order, y = ((const SampleItem *)b)->order;
+    return x < y ? -1 : x > y;
+}
+
+// Helper: draw the whole sample_rows= reservoir, then put the kept rows back
+// in stream order (presorted input stays sorted). Without a where filter,
+// rows the reservoir passes over are not split. Returns -1 when cancelled or
+// out of memory.
+static int reservoir_fill(BarSource *src)
+{
+    src->items = calloc(src->res.k, sizeof(SampleItem));
+    if (!src->items) { out_printf("Error: out of memory\n"); return -1; }
+
+    if (src->ds)
+    {
+        long r;
+        while ((r = where_scan_next(&src->scan)) >= 0)
+        {
+            src->row = r;
+            if (progress_tick(src)) draw_progress(src, NULL, 0, NULL, 0, 0);
+            long slot = reservoir_slot(&src->res, &src->rng);
+            if (slot < 0) continue;
+            src->items[slot].order = r;
+            src->items[slot].row = r;
+        }
+        if (cancel_requested()) return -1;
+        src->row = src->ds->nrows;
+    }
+    else
+    {
+        while (1)
+        {
+            long slot;
+            int nf;
+            if (progress_tick(src)) draw_progress(src, NULL, 0, NULL, 0, 0);
+            if (src->where)
+            {
+                if ((nf = csv_next(src->csv)) < 0) break;
+                if (!where_match(src->where, src->csv->fields, nf)) continue;
+                if ((slot = reservoir_slot(&src->res, &src->rng)) < 0) continue;
+            }
+            else if ((slot = reservoir_slot(&src->res, &src->rng)) < 0)
+            {
+                if (csv_skip(src->csv) < 0) { src->res.seen--; break; }
+                continue;
+            }
+            else if ((nf = csv_next(src->csv)) < 0) { src->res.seen--; break; }
+
+            SampleItem *it = &src->items[slot];
+            free(it->label);
+            it->label = NULL;
+            it->order = src->res.seen;
+            if (src->colX < nf && src->colY < nf && schema_number(src->typeY, src->csv->fields[src->colY], &it->y))
+            {
+                it->label = strdup(src->csv->fields[src->colX]);
+                if (!it->label) { out_printf("Error: out of memory\n"); return -1; }
+            }
+        }
+        if (cancel_requested()) return -1;
+    }
+
+    src->nitems = src->res.seen < src->res.k ? src->res.seen : src->res.k;
+    src->drawn = src->nitems;
+    src->fraction = src->res.seen ? (double)src->nitems / src->res.seen : 1;
+    qsort(src->items, src->nitems, sizeof(SampleItem), item_order);
+    return 0;
+}
+
+// Helper: release the sample a source kept
+static void source_free(BarSource *src)
+{
+    for (long i = 0; src->items && i < src->res.k; i++) free(src->items[i].label);
+    free(src->items);
+    src->items = NULL;
+    where_scan_end(&src->scan);
+}
+
+// Helper: the share of the data a finished sample covers, counted rather
+// than taken from the chance it was drawn with: rows drawn of the rows
+// passed, or for blocks the bytes read of the file. Scaled-up sums then do
+// not carry the luck of how many rows or blocks came up.
+static double sample_share(const BarSource *src)
+{
+    if (src->sample == SAMPLE_BLOCKS)
+    {
+        long long data = src->fileSize - src->dataStart;
+        return data > 0 ? (double)(src->csv->bytes - src->dataStart) / data : 1;
+    }
+    if (src->sample == SAMPLE_ROWS)
+    {
+        long passed = src->ds ? (src->row < src->ds->nrows ? src->row : src->ds->nrows) : src->csv->rows;
+        return passed > 0 && src->drawn > 0 ? (double)src->drawn / passed : src->fraction;
+    }
+    return src->fraction;
+}
+
+// Helper: next dataset row that is in the sample and passes the where
+// filter, -1 at the end. Without sample= the rows come from the where scan,
+// which visits only the rows the bitmap indexes leave when it can.
+static long source_row(BarSource *src)
+{
+    if (src->sample == SAMPLE_RESERVOIR)
+    {
+        if (!src->items && reservoir_fill(src) != 0) return -1;
+        return src->item < src->nitems ? src->items[src->item++].row : -1;
+    }
+    if (src->sample != SAMPLE_ROWS)
+    {
+        long r = where_scan_next(&src->scan);
+        src->row = r >= 0 ? r + 1 : src->ds->nrows;
+        return r;
+    }
+    while (1)
+    {
+        // the gap may pass several cancel checkpoints at once
+        long next = src->row + src->gap;
+        if (next / CANCEL_CHECK_ROWS != src->row / CANCEL_CHECK_ROWS && cancel_requested()) return -1;
+        src->row = next;
+        src->gap = sample_gap(&src->rng, src->fraction);
+        if (src->row >= src->ds->nrows)
+        {
+            src->row = src->ds->nrows;
+            return -1;
+        }
+        long r = src->row++;
+        src->drawn++;
+        if (src->where && !where_match_row(src->where, src->ds, r)) continue;
+        return r;
+    }
+}
+
+// Helper: read and split the next file row of the sample (every row when
+// not sampling), returns its field count or -1 at the end
+static int sampled_record(BarSource *src)
+{
+    CsvReader *csv = src->csv;
+    if (src->sample == SAMPLE_ROWS)
+    {
+        for (; src->gap > 0; src->gap--)
+            if (csv_skip(csv) < 0) return -1;
+        src->gap = sample_gap(&src->rng, src->fraction);
+    }
+    else if (src->sample == SAMPLE_BLOCKS)
+    {
+        // a block holds the rows that start inside it; past its end, seek
+        // to the next block drawn
+        while (src->block < 0 || src->seekPos + (csv->bytes - src->seekBytes) >= src->blockEnd)
+        {
+            src->block += 1 + src->gap;
+            src->gap = sample_gap(&src->rng, src->fraction);
+            if (src->block >= src->nblocks || cancel_requested()) return -1;
+            long long start = src->dataStart + (long long)src->block * SAMPLE_BLOCK_SIZE;
+            src->blockEnd = start + SAMPLE_BLOCK_SIZE;
+            if (csv_seek_record(csv, start, &src->seekPos) != 0) return -1;
+            src->seekBytes = csv->bytes;
+        }
+    }
+    int nf = csv_next(csv);
+    if (nf >= 0) src->drawn++;
+    return nf;
+}
+
+// Helper: next row of the source that passes the where filter: 1 with its
+// label and value, 0 for a row without a numeric Y (or too short), -1 at the end
+static int source_next(BarSource *src, const char **x, double *y)
+{
+    if (src->ds)
+    {
+        long r = source_row(src);
+        if (r < 0) return -1;
+        if (!dataset_number(src->ds, src->colY, r, y)) return 0;
+        *x = dataset_text(src->ds, src->colX, r, src->buf, sizeof(src->buf));
+        return 1;
+    }
+    if (src->sample == SAMPLE_RESERVOIR)
+    {
+        if (!src->items && reservoir_fill(src) != 0) return -1;
+        if (src->item >= src->nitems) return -1;
+        const SampleItem *it = &src->items[src->item++];
+        if (!it->label) return 0;
+        *x = it->label;
+        *y = it->y;
+        return 1;
+    }
+
+    int nf;
+    char **fields;
+    do
+    {
+        nf = src->join ? join_next(src->join) : sampled_record(src);
+        if (nf < 0) return -1;
+        fields = src->join ? src->join->fields : src->csv->fields;
+    } while (src->where && !where_match(src->where, fields, nf));
+    if (src->colX >= nf || src->colY >= nf) return 0;
+    if (!schema_number(src->typeY, fields[src->colY], y)) return 0;
+    *x = fields[src->colX];
+    return 1;
+}
+
+// Helper: order of the next X label after the current one while runs are
+// detected, 0 when they cannot be told apart. The labels compare as numbers
+// while every one has been a number and as strings while none has; a mix
+// has no single order (2 < 10 < 1a < 2), so it also gives 0. *kind keeps
+// which of the two the labels so far are: 0 not known yet, 1 numbers, 2 text.
+static int run_order(const char *next, const char *prev, int *kind)
+{
+    double x, y;
+    int numeric = csv_number(next, &x);
+    if (*kind == 0)
+    {
+        if (numeric != csv_number(prev, &y)) return 0;
+        *kind = numeric ? 1 : 2;
+    }
+    if (numeric != (*kind == 1)) return 0;
+    if (!numeric) return strcmp(next, prev);
+    csv_number(prev, &y);
+    return x < y ? -1 : x > y;
+}
+
+// Group rows by the X label string. Rows continuing the current label's run
+// are added without any lookup. While labels arrive sorted (either way) new
+// ones are appended without hashing, since they cannot have been seen; the
+// first label out of order switches to the hash table, which then indexes
+// the groups so far. With a limit, once the table outgrows it, its groups
+// and all later runs go to partition files by label hash instead, and the
+// partitions are aggregated one at a time into bs->runs; *out then stays empty.
+static int aggregate_labels(BarSource *src, const BarPlan *plan, BarSpill *bs, Group **out, QueryStats *stats)
+{
+    GroupTable t = {0};
+    Spill spill;
+    int spilled = 0, failed = 0;
+    long used = 0, rejected = 0;
+    int sorted = plan->presorted != 0, dir = 0, kind = 0, cur = -1;
+    Group run = {0};    // the current run while spilling
+    char *runLabel = NULL;
+
+    int rc;
+    const char *xval;
+    double val;
+    while (stats_stage(stats, STAGE_PARSE), (rc = source_next(src, &xval, &val)) >= 0) 
+    {
+        if (progress_tick(src)) draw_progress(src, t.groups, spilled ? 0 : t.gcount, NULL, 0, 0);
+        if (rc == 0) { rejected++; continue; }
+        stats_stage(stats, STAGE_AGGREGATE);
+        used++;
+
+        if (spilled)
+        {
+            // a run goes out as one partial group
+            if (runLabel && strcmp(runLabel, xval) == 0) { group_add(&run, val); continue; }
+            if (runLabel && spill_write(&spill, runLabel, &run) != 0) { failed = 1; break; }
+            free(runLabel);
+            runLabel = strdup(xval);
+            if (!runLabel) { out_printf("Error: out of memory\n"); failed = 1; break; }
+            memset(&run, 0, sizeof(run));
+            run.first = used;
+            group_add(&run, val);
+            continue;
+        }
+
+        if (cur >= 0 && strcmp(t.groups[cur].label, xval) == 0)
+        {
+            group_add(&t.groups[cur], val);
+            continue;
+        }
+
+        if (sorted && cur >= 0)
+        {
+            int cmp = run_order(xval, t.groups[cur].label, &kind);
+            if (dir == 0) dir = cmp;
+            if (cmp == 0 || (cmp > 0) != (dir > 0))
+            {
+                sorted = 0;
+                if (plan->presorted == 1) out_printf("Warning: x is not sorted at row %ld, grouping by hash\n", src->csv ? src->csv->rows : src->row);
+            }
+        }
+        Group *g = sorted ? group_table_append(&t, xval) : group_table_get(&t, xval);
+        if (!g) { out_printf("Error: out of memory\n"); failed = 1; break; }
+        if (g->count == 0) g->first = used;
+        group_add(g, val);
+        cur = (int)(g - t.groups);
+        if (plan->limit && t.bytes > plan->limit)
+        {
+            if (spill_open(&spill, 0) != 0) { failed = 1; break; }
+            if (runs_open(&bs->runs, bs->runs.order) != 0) { spill_close(&spill); failed = 1; break; }
+            spilled = 1;
+            if (spill_table(&spill, &t) != 0) { failed = 1; break; }
+        }
+    }
+    if (!failed && runLabel && spill_write(&spill, runLabel, &run) != 0) failed = 1;
+    free(runLabel);
+    stats_count(stats, STAGE_AGGREGATE, used, 0);
+    if (stats) stats->rows_rejected += rejected;
+
+    int gcount = -1;
+    *out = NULL;
+    if (!failed && !cancel_requested())
+    {
+        if (spilled)
+        {
+            stats_stage(stats, STAGE_AGGREGATE);
+            if (spill_aggregate(&spill, plan->limit, spill_results, bs) == 0) gcount = 0;
+            stats_stage(stats, STAGE_NONE);
+            if (stats) stats->spill_bytes += spill.bytes + bs->runs.bytes;
+        }
+        else
+        {
+            *out = t.groups;
+            gcount = t.gcount;
+            t.groups = NULL;
+            t.gcount = 0;
+        }
+    }
+    if (spilled) spill_close(&spill);
+    group_table_free(&t);
+    return gcount;
+}
+
+// Helper: order groups by the first row they were given
+static int group_first_order(const void *a, const void *b)
+{
+    long x = ((const Group *)a)->first, y = ((const Group *)b)->first;
+    return x < y ? -1 : x > y;
+}
+
+// Group a dictionary-encoded dataset column: the code of each row indexes
+// the group array directly, so there is no hashing or string comparison.
+// A text Y column is parsed once per distinct value, not once per row.
+static int aggregate_codes(BarSource *src, Group **out, QueryStats *stats)
+{
+    const Column *cx = &src->ds->cols[src->colX];
+    const Column *cy = &src->ds->cols[src->colY];
+
+    Group *slots = calloc(cx->ndict ? cx->ndict : 1, sizeof(Group));
+    double *dictY = NULL;
+    if (cy->type == COLUMN_TEXT)
+    {
+        dictY = malloc((cy->ndict ? cy->ndict : 1) * sizeof(double));
+        if (dictY)
+            for (uint32_t i = 0; i < cy->ndict; i++)
+                if (!csv_number(cy->dict[i], &dictY[i])) dictY[i] = NAN;
+    }
+    if (!slots || (cy->type == COLUMN_TEXT && !dictY))
+    {
+        out_printf("Error: out of memory\n");
+        free(slots);
+        free(dictY);
+        return -1;
+    }
+
+    stats_stage(stats, STAGE_AGGREGATE);
+    long used = 0, rejected = 0;
+    const uint32_t *codes = cx->codes;
+    long r;
+    while ((r = source_row(src)) >= 0)
+    {
+        if (progress_tick(src)) draw_progress(src, slots, cx->ndict, cx->dict, 0, 0);
+        double val;
+        if (dictY) val = dictY[cy->codes[r]];
+        else if (!dataset_number(src->ds, src->colY, r, &val)) val = NAN;
+        if (isnan(val)) { rejected++; continue; }
+        Group *g = &slots[codes[r]];
+        if (g->count == 0) g->first = r;
+        group_add(g, val);
+        used++;
+    }
+    stats_count(stats, STAGE_AGGREGATE, used, 0);
+    if (stats) stats->rows_rejected += rejected;
+    free(dictY);
+    if (cancel_requested())
+    {
+        free(slots); // no labels yet
+        return -1;
+    }
+
+    // compact the codes that got rows. Codes follow first appearance in the
+    // whole dataset; when where= or sample= passed over rows, the groups are
+    // put in order of their first row that was used, as a file scan gives.
+    int gcount = 0, ordered = 1;
+    for (uint32_t i = 0; i < cx->ndict; i++)
+    {
+        if (slots[i].count == 0) continue;
+        if (gcount > 0 && slots[i].first < slots[gcount - 1].first) ordered = 0;
+        slots[gcount] = slots[i];
+        slots[gcount].label = strdup(cx->dict[i]);
+        gcount++;
+    }
+    if (!ordered) qsort(slots, gcount, sizeof(Group), group_first_order);
+
+    *out = slots;
+    return gcount;
+}
+
+// Group rows by time bucket. The bucket number indexes a dense slot array
+// directly, so no label is built or compared until the scan is over.
+static int aggregate_buckets(BarSource *src, long long width, Group **out, QueryStats *stats)
+{
+    Group *slots = NULL;
+    long long base = 0, minB = 0, maxB = 0;
+    long nslots = 0;
+    long skipped = 0, used = 0, rejected = 0;
+
+    int rc;
+    const char *xval;
+    double val;
+    while (stats_stage(stats, STAGE_PARSE), (rc = source_next(src, &xval, &val)) >= 0)
+    {
+        if (progress_tick(src)) draw_progress(src, slots, nslots, NULL, base, width);
+        if (rc == 0) { rejected++; continue; }
+
+        long long t;
+        if (!ts_parse(xval, &t)) { skipped++; continue; }
+        stats_stage(stats, STAGE_AGGREGATE);
+        used++;
+
+        long long b = ts_bucket_index(t, width);
+        if (nslots == 0 || b < base || b >= base + nslots)
+        {
+            // widen the slot range to cover b
+            long long lo = nslots == 0 || b < minB ? b : minB;
+            long long hi = nslots == 0 || b > maxB ? b : maxB;
+            if (hi - lo + 1 > MAX_TIME_BUCKETS)
+            {
+                out_printf("Error: more than %d buckets between first and last time, use a wider bucket\n", MAX_TIME_BUCKETS);
+                free(slots);
+                return -1;
+            }
+
+            // grow geometrically towards b so an ordered scan only reallocates O(log n) times
+            long long pad = hi - lo + 1 < 64 ? 64 : hi - lo + 1;
+            if (pad > MAX_TIME_BUCKETS - (hi - lo + 1)) pad = MAX_TIME_BUCKETS - (hi - lo + 1);
+            if (nslots && b < minB) lo -= pad;
+            else hi += pad;
+
+            long ncount = (long)(hi - lo + 1);
+            Group *ns = calloc(ncount, sizeof(Group));
+            if (!ns) { out_printf("Error: out of memory\n"); free(slots); return -1; }
+            if (nslots) memcpy(ns + (minB - lo), slots + (minB - base), (maxB - minB + 1) * sizeof(Group));
+            else minB = maxB = b;
+            free(slots);
+            slots = ns;
+            base = lo;
+            nslots = ncount;
+        }
+        if (b < minB) minB = b;
+        if (b > maxB) maxB = b;
+        group_add(&slots[b - base], val);
+    }
+
+    stats_count(stats, STAGE_AGGREGATE, used, 0);
+    if (stats) stats->rows_rejected += rejected + skipped;
+    if (cancel_requested())
+    {
+        free(slots); // no labels yet
+        return -1;
+    }
+    if (skipped > 0) out_printf("Warning: %ld rows with an unreadable time skipped\n", skipped);
+
+    // compact occupied slots, in time order, and label them
     int gcount = 0;
+    for (long i = 0; i < nslots; i++)
+    {
+        if (slots[i].count == 0) continue;
+        char buf[32];
+        ts_format(ts_bucket_start(base + i, width), width, buf, sizeof(buf));
+        slots[gcount] = slots[i];
+        slots[gcount].label = strdup(buf);
+        gcount++;
+    }
+
+    *out = slots;
+    return gcount;
+}
+
+// Resolve a query against a header: X/Y column indexes, the where filter,
+// the bucket width, the memory limit, the presorted hint and the sample. Prints the
+// problem and returns -1 when it cannot run.
+int bar_plan(const BarOptions *opts, char **header, int ncols, BarPlan *plan)
+{
+    memset(plan, 0, sizeof(*plan));
+    plan->colX = plan->colY = -1;
+    if (opts->bucket && !ts_bucket_width(opts->bucket, &plan->width))
+    {
+        out_printf("Error: unknown bucket '%s'. Use e.g. 30s, 15m, 1h, 1d, 1w\n", opts->bucket);
+        return -1;
+    }
+    if (opts->mem_limit && !group_limit(opts->mem_limit, &plan->limit))
+    {
+        out_printf("Error: unknown mem_limit '%s'. Use e.g. 512k, 64m, 1g\n", opts->mem_limit);
+        return -1;
+    }
+    plan->presorted = opts->presorted ? option_enabled(opts->presorted) : -1;
+    if (opts->sample && (!csv_number(opts->sample, &plan->fraction) || plan->fraction <= 0 || plan->fraction > 1))
+    {
+        out_printf("Error: sample must be a fraction above 0 and at most 1 -> %s\n", opts->sample);
+        return -1;
+    }
+    if (opts->sample_rows && (mathi_str_to_int(opts->sample_rows, &plan->sampleRows) != 0 || plan->sampleRows < 1))
+    {
+        out_printf("Error: sample_rows must be a positive row count -> %s\n", opts->sample_rows);
+        return -1;
+    }
+    if (opts->sample && opts->sample_rows)
+    {
+        out_printf("Error: use either sample or sample_rows, not both\n");
+        return -1;
+    }
+    if ((opts->sample || opts->sample_rows) && plan->limit)
+    {
+        out_printf("Error: sample cannot be combined with mem_limit\n");
+        return -1;
+    }
+    if ((opts->sample || opts->sample_rows) && opts->join)
+    {
+        out_printf("Error: sample cannot be combined with join\n");
+        return -1;
+    }
+    if (opts->window && !window_parse(opts->window, &plan->window))
+    {
+        out_printf("Error: unknown window '%s'. Use a count such as 7, or a span such as 12h, 7d, 2w\n", opts->window);
+        return -1;
+    }
+    if (opts->window && plan->limit)
+    {
+        out_printf("Error: window cannot be combined with mem_limit\n");
+        return -1;
+    }
+    if (plan->fraction == 1) plan->fraction = 0; // every row: an exact query
+
+    for (int c = 0; c < ncols; c++)
+    {
+        if (plan->colX == -1 && strcmp(header[c], opts->x) == 0) plan->colX = c;
+        if (plan->colY == -1 && strcmp(header[c], opts->y) == 0) plan->colY = c;
+    }
+    if (plan->colX == -1 || plan->colY == -1)
+    {
+        out_printf("Error: columns not found -> x:%s y:%s\n", opts->x, opts->y);
+        return -1;
+    }
 
-    while (fgets(line, sizeof(line), fp)) 
+    if (opts->where && (where_parse(opts->where, &plan->where) != 0 || where_bind(&plan->where, header, ncols) != 0))
     {
-        idx = 0;
-        token = strtok(line, ",");
-        char *xval = NULL, *yval = NULL;
+        where_free(&plan->where);
+        return -1;
+    }
+    return 0;
+}
+
+// Release what a plan holds
+void bar_plan_free(BarPlan *plan)
+{
+    where_free(&plan->where);
+}
+
+// Helper: order groups by X label, numbers before text
+static int group_label_order(const void *a, const void *b)
+{
+    return csv_label_order(((const Group *)a)->label, ((const Group *)b)->label);
+}
 
-        while (token) 
+// Helper: for window=, put the groups in X order and replace each one by
+// the aggregate of its window: itself and the groups before it, N of them
+// or those whose X (a time) is less than the span behind. Sums and counts
+// add up, so the average is over the rows of the whole window. Returns -1
+// with a message when X is not a time for a span or when out of memory.
+static int window_groups(const BarOptions *opts, Group *groups, int gcount, const WindowSpec *spec)
+{
+    qsort(groups, gcount, sizeof(Group), group_label_order);
+    Rolling r;
+    if (rolling_init(&r, spec) != 0)
+    {
+        out_printf("Error: out of memory\n");
+        return -1;
+    }
+    for (int i = 0; i < gcount; i++)
+    {
+        Group *g = &groups[i];
+        WindowEntry e = {0, g->sum, g->sumsq, g->count, g->min, g->max, 0};
+        long long t = 0;
+        if (spec->span && !ts_parse(g->label, &t))
         {
-            trim(token);
-            if (idx == colX_idx) xval = token;
-            if (idx == colY_idx) yval = token;
-            idx++;
-            token = strtok(NULL, ",");
+            out_printf("Error: window='%s' needs x values that are times -> %s\n", opts->window, g->label);
+            rolling_free(&r);
+            return -1;
         }
+        e.x = (double)t;
+        if (rolling_push(&r, &e) != 0)
+        {
+            out_printf("Error: out of memory\n");
+            rolling_free(&r);
+            return -1;
+        }
+        g->sum = r.sum;
+        g->sumsq = r.sumsq;
+        g->count = (int)r.count;
+        g->min = rolling_min(&r);
+        g->max = rolling_max(&r);
+    }
+    rolling_free(&r);
+    return 0;
+}
+
+// Helper: true when the query should print JSON instead of a chart
+static int json_output(const BarOptions *opts)
+{
+    return opts->format && strcmp(opts->format, "json") == 0;
+}
+
+static void finish_spilled(const BarOptions *opts, GroupRuns *runs, QueryStats *stats);
+
+// Helper: answer a file query from the rollup cube next to the file, when
+// one covers x, y and the where= columns and the query needs nothing the
+// cube does not keep (buckets, samples, a join). Returns -1, having printed
+// at most a stale-cube warning, when the file has to be scanned instead.
+static int draw_from_cube(const BarOptions *opts, const BarPlan *plan, QueryStats *stats)
+{
+    if (opts->bucket || opts->join || opts->sample || opts->sample_rows) return -1;
+    if (opts->cube && !option_enabled(opts->cube)) return -1;
+    WindowSpec window = {0};
+    if (plan) window = plan->window;
+    else if (opts->window && !window_parse(opts->window, &window)) return -1; // bar_plan reports it
+    if (bar_compute(opts) < 0) return 0;
+
+    Group *groups = NULL;
+    long long bytes = 0;
+    stats_stage(stats, STAGE_PARSE);
+    int gcount = cube_query(opts->file, opts->x, opts->y, opts->where, &groups, &bytes);
+    stats_stage(stats, STAGE_NONE);
+    if (gcount < 0) return -1;
+    stats_count(stats, STAGE_PARSE, gcount, bytes);
+    if (stats)
+    {
+        stats->cache_hits++;
+        stats->bytes_read += bytes;
+    }
+    int failed = gcount > 0 && (window.count || window.span) && window_groups(opts, groups, gcount, &window) != 0;
+    if (!failed) finish_bar(opts, groups, gcount, NULL, stats);
+    groups_free(groups, gcount);
+    return 0;
+}
 
-        if (!xval || !yval) continue;
+// Draw bar graph. With a plan the columns are taken from it as they are;
+// without one they are resolved against the header just read.
+void draw_bar(const BarOptions *opts, const BarPlan *plan, QueryStats *stats) 
+{
+    BarSource src = {0};
+    CsvReader csv;
+    Join join;
+    BarPlan local;
+    int ownPlan = 0;
+    long headerBytes = 0;
+    if (opts->data)
+    {
+        // a loaded dataset: no file is opened or parsed
+        src.ds = dataset_acquire(opts->data);
+        if (!src.ds)
+        {
+            out_printf("Error: dataset not loaded -> %s\n", opts->data);
+            return;
+        }
+        if (stats) stats->cache_hits++;
+        if (!plan)
+        {
+            if (bar_plan(opts, src.ds->header, src.ds->ncols, &local) != 0)
+            {
+                dataset_release(src.ds);
+                return;
+            }
+            plan = &local;
+            ownPlan = 1;
+        }
+    }
+    else if (draw_from_cube(opts, plan, stats) == 0) return;
+    else
+    {
+        stats_stage(stats, STAGE_OPEN);
+        if (csv_open_file(&csv, opts->file) != 0) 
+        {
+            stats_stage(stats, STAGE_NONE);
+            out_printf("Error: could not open file: %s\n", opts->file);
+            return;
+        }
 
-        char *endptr;
-        double val = strtod(yval, &endptr);
-        if (endptr == yval || *endptr != '\0') continue;
+        stats_stage(stats, STAGE_HEADER);
+        if (csv_read_header(&csv) != 0) 
+        {
+            stats_stage(stats, STAGE_NONE);
+            out_printf("Error: empty file\n");
+            csv_close(&csv);
+            return;
+        }
 
-        int found = 0;
-        for (int i = 0; i < gcount; i++) 
+        // Find X and Y column indexes, in the joined columns with join=
+        src.csv = &csv;
+        src.fileSize = mathi_file_size(opts->file);
+        if (opts->join)
+        {
+            if (join_open(&join, &csv, opts->file, opts->join, opts->on) != 0)
+            {
+                stats_stage(stats, STAGE_NONE);
+                csv_close(&csv);
+                return;
+            }
+            src.join = &join;
+            src.csv = join.probe;
+            src.fileSize = mathi_file_size(join.probe == &csv ? opts->file : opts->join);
+        }
+        headerBytes = csv.bytes + (src.join ? join.other.bytes : 0);
+        stats_count(stats, STAGE_HEADER, 1 + (src.join != NULL), headerBytes);
+        if (!plan)
         {
-            if (strcmp(groups[i].label, xval) == 0) 
+            if (bar_plan(opts, src.join ? join.header : csv.header, src.join ? join.ncols : csv.ncols, &local) != 0)
             {
-                groups[i].sum += val;
-                groups[i].count++;
-                if (val < groups[i].min) groups[i].min = val;
-                if (val > groups[i].max) groups[i].max = val;
-                found = 1;
-                break;
+                stats_stage(stats, STAGE_NONE);
+                if (src.join) join_close(&join);
+                csv_close(&csv);
+                return;
             }
+            plan = &local;
+            ownPlan = 1;
         }
+    }
+    src.colX = plan->colX;
+    src.colY = plan->colY;
+    src.where = plan->where.nclauses > 0 ? &plan->where : NULL;
+
+    // a plan made for another copy of the data may point past its columns
+    int ncols = src.ds ? src.ds->ncols : src.join ? join.ncols : csv.ncols;
+    int ok = src.colX < ncols && src.colY < ncols;
+    for (int i = 0; ok && i < plan->where.nterms; i++) ok = plan->where.terms[i].col < ncols;
+    if (!ok)
+    {
+        stats_stage(stats, STAGE_NONE);
+        out_printf("Error: columns not found -> x:%s y:%s\n", opts->x, opts->y);
+        if (ownPlan) bar_plan_free(&local);
+        if (src.join) join_close(&join);
+        if (src.csv) csv_close(&csv);
+        dataset_release(src.ds);
+        return;
+    }
 
-        if (!found) 
+    if (src.csv)
+    {
+        // the sniffed Y type picks the number parser (cached per file)
+        const char *file = opts->file;
+        int col = src.colY, fileCols = csv.ncols;
+        if (col >= csv.ncols)
         {
-            groups[gcount].label = strdup(xval);
-            groups[gcount].sum = val;
-            groups[gcount].count = 1;
-            groups[gcount].min = val;
-            groups[gcount].max = val;
-            gcount++;
+            file = opts->join;
+            col -= csv.ncols;
+            fileCols = join.other.ncols;
         }
+        SchemaType *types = malloc(fileCols * sizeof(SchemaType));
+        if (types && schema_get(file, types, fileCols) == 0) src.typeY = types[col];
+        free(types);
+    }
+    if (plan->fraction > 0 || plan->sampleRows > 0) source_sample(&src, plan);
+
+    // Progress frames and results that spill are computed while scanning,
+    // so check compute (and sort) now
+    BarSpill spill = {0};
+    src.compute = spill.compute = bar_compute(opts);
+    if (src.compute < 0)
+    {
+        stats_stage(stats, STAGE_NONE);
+        if (ownPlan) bar_plan_free(&local);
+        if (src.join) join_close(&join);
+        if (src.csv) csv_close(&csv);
+        dataset_release(src.ds);
+        return;
     }
-    fclose(fp);
 
-    if (gcount == 0) { printf("No rows to plot.\n"); return; }
+    // the smaller file of a join is read into its hash table up front
+    if (src.join && (stats_stage(stats, STAGE_PARSE), join_build(&join)) != 0)
+    {
+        stats_stage(stats, STAGE_NONE);
+        if (ownPlan) bar_plan_free(&local);
+        join_close(&join);
+        csv_close(&csv);
+        return;
+    }
+    if (plan->limit && opts->sort)
+    {
+        if (strcmp(opts->sort,"y")==0) spill.runs.order = RUNS_BY_VALUE;
+        else if (strcmp(opts->sort,"x")==0) spill.runs.order = RUNS_BY_LABEL;
+    }
+
+    Progress progress;
+    if (!json_output(opts) && progress_wanted(opts->progress))
+    {
+        progress_start(&progress);
+        src.progress = &progress;
+    }
+
+    // Read data and aggregate
+    if (src.ds && src.sample != SAMPLE_ROWS) where_scan_start(&src.scan, &plan->where, src.ds);
+    Group *groups = NULL;
+    int gcount;
+    if (opts->bucket) gcount = aggregate_buckets(&src, plan->width, &groups, stats);
+    else if (src.ds && src.ds->cols[src.colX].type == COLUMN_TEXT) gcount = aggregate_codes(&src, &groups, stats);
+    else gcount = aggregate_labels(&src, plan, &spill, &groups, stats);
+    stats_stage(stats, STAGE_NONE);
+    if (ownPlan) bar_plan_free(&local);
+    if (src.progress) progress_erase(&progress);
+
+    BarSample sample = {src.sample ? sample_share(&src) : 1, src.drawn, src.sample == SAMPLE_RESERVOIR};
+    long rows = src.csv ? csv.rows : src.sample == SAMPLE_ROWS ? src.row : src.scan.visited;
+    long bytes = src.csv ? csv.bytes : 0;
+    long unmatched = 0;
+    if (src.join)
+    {
+        rows += join.other.rows;
+        bytes += join.other.bytes;
+        unmatched = join_unmatched(&join);
+        join_close(&join);
+    }
+    stats_count(stats, STAGE_PARSE, rows, bytes - headerBytes);
+    if (stats)
+    {
+        stats->rows_scanned += rows;
+        stats->rows_rejected += unmatched;
+        stats->bytes_read += bytes;
+    }
+    if (src.csv) csv_close(&csv);
+    dataset_release(src.ds);
+    source_free(&src);
+    int failed = gcount > 0 && (plan->window.count || plan->window.span) && window_groups(opts, groups, gcount, &plan->window) != 0;
+    if (gcount >= 0 && spill.runs.file) finish_spilled(opts, &spill.runs, stats);
+    else if (gcount >= 0 && !failed) finish_bar(opts, groups, gcount, src.sample ? &sample : NULL, stats);
+    if (gcount >= 0 && unmatched > 0 && !json_output(opts))
+        out_printf("(%ld rows without a match in %s skipped)\n", unmatched, opts->join);
+    groups_free(groups, gcount > 0 ? gcount : 0);
+    runs_close(&spill.runs);
+}
+
+// Helper: the query options (and how a sample was drawn) as a JSON object,
+// NULL when out of memory
+static MathiJSON *bar_json_doc(const BarOptions *opts, const BarSample *sample)
+{
+    MathiJSON *doc = mathison_new_object();
+    if (!doc) return NULL;
+    mathison_set_value(doc, "command", mathison_new_string("bar"));
+    if (opts->data) mathison_set_value(doc, "data", mathison_new_string(opts->data));
+    else mathison_set_value(doc, "file", mathison_new_string(opts->file));
+    mathison_set_value(doc, "x", mathison_new_string(opts->x));
+    mathison_set_value(doc, "y", mathison_new_string(opts->y));
+    mathison_set_value(doc, "compute", mathison_new_string(opts->compute ? opts->compute : "avg"));
+    if (opts->bucket) mathison_set_value(doc, "bucket", mathison_new_string(opts->bucket));
+    if (opts->window) mathison_set_value(doc, "window", mathison_new_string(opts->window));
+    if (sample)
+    {
+        MathiJSON *info = mathison_new_object();
+        if (!info) { mathison_free(doc); return NULL; }
+        mathison_set_value(info, "fraction", mathison_new_number(sample->fraction));
+        mathison_set_value(info, "rows", mathison_new_number(sample->rows));
+        mathison_set_value(info, "confidence", mathison_new_number(0.95));
+        mathison_set_value(doc, "sample", info);
+    }
+    return doc;
+}
+
+// Helper: print one query as a JSON line: options, results and statistics
+static void print_bar_json(const BarOptions *opts, const BarSample *sample, MathiJSON *results, const QueryStats *stats)
+{
+    MathiJSON *doc = bar_json_doc(opts, sample);
+    if (!doc || !results)
+    {
+        out_printf("Error: out of memory\n");
+        if (doc) mathison_free(doc);
+        if (results) mathison_free(results);
+        return;
+    }
+
+    mathison_set_value(doc, "results", results);
+    if (stats) mathison_set_value(doc, "stats", stats_json(stats));
+    json_print(doc);
+    mathison_free(doc);
+}
+
+// Helper: label/value pairs in display order, with the confidence interval
+// half-width as "ci" where a sampled value has one
+static MathiJSON *bar_results_json(char **labels, const double *values, const double *errs, int count)
+{
+    MathiJSON *results = mathison_new_array();
+    if (!results) return NULL;
+    for (int i = 0; i < count; i++)
+    {
+        MathiJSON *item = mathison_new_object();
+        if (!item) { mathison_free(results); return NULL; }
+        mathison_set_value(item, "label", mathison_new_string(labels[i]));
+        mathison_set_value(item, "value", mathison_new_number(values[i]));
+        if (errs && !isnan(errs[i])) mathison_set_value(item, "ci", mathison_new_number(errs[i]));
+        mathison_append_array(results, item);
+    }
+    return results;
+}
+
+// One result while sort= orders them; pos keeps ties in group order
+typedef struct {
+    char *label;
+    double value;
+    double err;
+    int pos;
+} SortedResult;
+
+// Helper: qsort order by value descending
+static int result_by_value(const void *a, const void *b)
+{
+    const SortedResult *x = a, *y = b;
+    if (x->value != y->value) return x->value < y->value ? 1 : -1;
+    return x->pos - y->pos;
+}
+
+// Helper: qsort order by label alphabetically
+static int result_by_label(const void *a, const void *b)
+{
+    const SortedResult *x = a, *y = b;
+    int cmp = strcmp(x->label, y->label);
+    return cmp ? cmp : x->pos - y->pos;
+}
+
+// Helper: sort the results in place with one of the orders above.
+// Returns -1 when out of memory.
+static int sort_results(char **labels, double *values, double *errs, int n, int (*order)(const void *, const void *))
+{
+    SortedResult *items = malloc((n ? n : 1) * sizeof(SortedResult));
+    if (!items) return -1;
+    for (int i = 0; i < n; i++)
+    {
+        SortedResult it = {labels[i], values[i], errs ? errs[i] : 0, i};
+        items[i] = it;
+    }
+    qsort(items, n, sizeof(SortedResult), order);
+    for (int i = 0; i < n; i++)
+    {
+        labels[i] = items[i].label;
+        values[i] = items[i].value;
+        if (errs) errs[i] = items[i].err;
+    }
+    free(items);
+    return 0;
+}
+
+// Apply compute and sort to aggregated groups, then render them. Groups of a
+// sampled query (sample is NULL otherwise) give estimates with intervals.
+void finish_bar(const BarOptions *opts, Group *groups, int gcount, const BarSample *sample, QueryStats *stats)
+{
+    if (stats) stats->groups = gcount;
+    if (gcount == 0)
+    {
+        if (json_output(opts)) print_bar_json(opts, sample, mathison_new_array(), stats);
+        else out_printf("No rows to plot.\n");
+        return;
+    }
 
     // Compute values
-    double values[500], maxVal = -1e9;
-    int useSum=0, useAvg=0, useMax=0, useMin=0;
-    if (!opts->compute) useAvg = 1;
-    else 
+    int compute = bar_compute(opts);
+    if (compute < 0) return;
+
+    double *values = malloc(gcount * sizeof(double));
+    char **labels = malloc(gcount * sizeof(char *));
+    double *errs = sample ? malloc(gcount * sizeof(double)) : NULL;
+    if (!values || !labels || (sample && !errs))
     {
-        if (strcmp(opts->compute,"sum")==0) useSum=1;
-        else if (strcmp(opts->compute,"avg")==0) useAvg=1;
-        else if (strcmp(opts->compute,"max")==0) useMax=1;
-        else if (strcmp(opts->compute,"min")==0) useMin=1;
-        else { printf("Error: unknown compute '%s'.\n", opts->compute); return; }
+        out_printf("Error: out of memory\n");
+        free(values); free(labels); free(errs);
+        return;
     }
 
     for (int i=0;i<gcount;i++)
     {
-        if (useSum) values[i]=groups[i].sum;
-        else if (useAvg) values[i]=groups[i].sum/groups[i].count;
-        else if (useMax) values[i]=groups[i].max;
-        else if (useMin) values[i]=groups[i].min;
-        if (values[i]>maxVal) maxVal=values[i];
+        labels[i]=groups[i].label;
+        values[i]=group_value(&groups[i], compute);
+        if (!sample) continue;
+        if (compute == COMPUTE_SUM) values[i] /= sample->fraction;
+        errs[i]=group_interval(&groups[i], compute, sample->fraction);
     }
 
     // the optional sort
+    stats_stage(stats, STAGE_SORT);
+    stats_count(stats, STAGE_SORT, opts->sort ? gcount : 0, 0);
     if (opts->sort) 
     {
-        if (strcmp(opts->sort,"y")==0)
+        int (*order)(const void *, const void *) = NULL;
+        if (strcmp(opts->sort,"y")==0) order = result_by_value;
+        else if (strcmp(opts->sort,"x")==0) order = result_by_label;
+        else out_printf("Warning: unknown sort option '%s'. Ignored.\n", opts->sort);
+        if (order && sort_results(labels, values, errs, gcount, order) != 0)
         {
-            // sort by value descending
-            for(int i=0;i<gcount-1;i++)
-                for(int j=i+1;j<gcount;j++)
-                    if(values[j]>values[i])
-                    {
-                        double tmp=values[i]; values[i]=values[j]; values[j]=tmp;
-                        char *tlabel=groups[i].label; groups[i].label=groups[j].label; groups[j].label=tlabel;
-                    }
-        } 
-        else if (strcmp(opts->sort,"x")==0)
-        {
-            // sort by label alphabetically
-            for(int i=0;i<gcount-1;i++)
-                for(int j=i+1;j<gcount;j++)
-                    if(strcmp(groups[i].label,groups[j].label)>0)
-                    {
-                        double tmp=values[i]; values[i]=values[j]; values[j]=tmp;
-                        char *tlabel=groups[i].label; groups[i].label=groups[j].label; groups[j].label=tlabel;
-                    }
-        } 
-        else 
-        {
-            printf("Warning: unknown sort option '%s'. Ignored.\n", opts->sort);
+            out_printf("Error: out of memory\n");
+            free(values); free(labels); free(errs);
+            return;
         }
     }
 
-    // Print title
-    if (opts->title) printf("\n%s\n\n", opts->title);
+    // the JSON document is built inside the render stage but printed after
+    // it, so that its own timing is complete
+    MathiJSON *results = NULL;
+    stats_stage(stats, STAGE_RENDER);
+    if (json_output(opts)) results = bar_results_json(labels, values, errs, gcount);
+    else render_bars(opts->title, labels, values, errs, gcount);
+    stats_stage(stats, STAGE_NONE);
+    stats_count(stats, STAGE_RENDER, gcount, 0);
+    if (json_output(opts)) print_bar_json(opts, sample, results, stats);
+    else if (sample && sample->reservoir)
+    {
+        out_printf("(estimated from %ld of %.0f rows; ± is a 95%% confidence interval)\n",
+                   sample->rows, sample->rows / sample->fraction);
+    }
+    else if (sample)
+    {
+        out_printf("(estimated from a %.3g%% sample of %ld rows, about %.0f in all; ± is a 95%% confidence interval)\n",
+                   sample->fraction * 100, sample->rows, sample->rows / sample->fraction);
+    }
+    free(values);
+    free(labels);
+    free(errs);
+}
 
-    // Draw bars
-    for(int i=0;i<gcount;i++)
+// Helper: where streamed results go, and how the chart is laid out
+typedef struct {
+    int json;
+    long written;
+    double maxVal;
+    int labelWidth;
+} ResultWriter;
+
+// Helper: write one streamed result as a bar or as a JSON array item
+static int write_result(const GroupResult *item, void *ctx)
+{
+    ResultWriter *w = ctx;
+    if (!w->json)
     {
-        int barLen=(int)((values[i]/maxVal)*MAX_BAR_WIDTH);
-        printf("%-15s | ", groups[i].label);
-        repeat_char('#', barLen);
-        printf(" (%.2f)\n", values[i]);
-        free(groups[i].label);
+        render_bar_row(item->label, item->value, NAN, w->maxVal, w->labelWidth);
+        return 0;
     }
-    printf("\n");
+    if (w->written++) out_putchar(',');
+    fputs("{\"label\":", output_stream());
+    json_write_string(item->label);
+    fputs(",\"value\":", output_stream());
+    json_write_number(item->value);
+    out_putchar('}');
+    return 0;
 }
 
-// Display bar command
-void display_bar(char *command)
+// Render results that were spilled to disk: the chart or the JSON line is
+// written while the runs are read back (merged when sort= is given), so the
+// results are never all in memory
+static void finish_spilled(const BarOptions *opts, GroupRuns *runs, QueryStats *stats)
 {
-    BarOptions opts={0}; // null all members
-    opts.file=get_option_value(command,"file=");
-    opts.x=get_option_value(command,"x=");
-    opts.y=get_option_value(command,"y=");
-    opts.title=get_option_value(command,"title=");
-    opts.compute=get_option_value(command,"compute=");
-    opts.sort=get_option_value(command,"sort=");
+    if (runs->count == 0)
+    {
+        finish_bar(opts, NULL, 0, NULL, stats);
+        return;
+    }
+    if (stats) stats->groups = runs->count;
+    if (opts->sort && strcmp(opts->sort,"y")!=0 && strcmp(opts->sort,"x")!=0)
+    {
+        out_printf("Warning: unknown sort option '%s'. Ignored.\n", opts->sort);
+    }
+    stats_count(stats, STAGE_SORT, opts->sort ? runs->count : 0, 0);
+
+    ResultWriter w = {json_output(opts), 0, runs->maxValue, label_width(runs->maxLabel)};
+    MathiJSON *doc = NULL;
+    if (w.json)
+    {
+        doc = bar_json_doc(opts, NULL);
+        if (!doc) { out_printf("Error: out of memory\n"); return; }
+    }
+
+    // the merge is timed as rendering: both happen in the same pass
+    stats_stage(stats, STAGE_RENDER);
+    if (w.json)
+    {
+        out_putchar('{');
+        json_write_members(doc);
+        fputs(",\"results\":[", output_stream());
+    }
+    else if (opts->title) out_printf("\n%s\n\n", opts->title);
+    int rc = runs_each(runs, write_result, &w);
+    stats_stage(stats, STAGE_NONE);
+    stats_count(stats, STAGE_RENDER, runs->count, 0);
+
+    if (w.json)
+    {
+        // a failed read still closes the line, so it stays one JSON document
+        fputs("]", output_stream());
+        MathiJSON *st = stats ? stats_json(stats) : NULL;
+        if (st)
+        {
+            fputs(",\"stats\":", output_stream());
+            json_write(st);
+            mathison_free(st);
+        }
+        fputs("}\n", output_stream());
+        mathison_free(doc);
+    }
+    else if (rc == 0) out_printf("\n");
+}
+
+// Parse bar options from a command line; absent options stay NULL
+void bar_options(const char *command, BarOptions *opts)
+{
+    memset(opts, 0, sizeof(*opts)); // null all members
+    opts->file=get_option_value(command,"file=");
+    opts->data=get_option_value(command,"data=");
+    opts->x=get_option_value(command,"x=");
+    opts->y=get_option_value(command,"y=");
+    opts->title=get_option_value(command,"title=");
+    opts->compute=get_option_value(command,"compute=");
+    opts->sort=get_option_value(command,"sort=");
+    opts->bucket=get_option_value(command,"bucket=");
+    opts->profile=get_option_value(command,"profile=");
+    opts->format=get_option_value(command,"format=");
+    opts->where=get_option_value(command,"where=");
+    opts->mem_limit=get_option_value(command,"mem_limit=");
+    opts->presorted=get_option_value(command,"presorted=");
+    opts->sample=get_option_value(command,"sample=");
+    opts->sample_rows=get_option_value(command,"sample_rows=");
+    opts->progress=get_option_value(command,"progress=");
+    opts->join=get_option_value(command,"join=");
+    opts->on=get_option_value(command,"on=");
+    opts->window=get_option_value(command,"window=");
+    opts->cube=get_option_value(command,"cube=");
 
     // lowercase strings // from mathi c
-    if(opts.x) mathi_string_to_lower(opts.x);
-    if(opts.y) mathi_string_to_lower(opts.y);
-    if(opts.compute) mathi_string_to_lower(opts.compute);
-    if(opts.sort) mathi_string_to_lower(opts.sort);
+    if(opts->x) mathi_string_to_lower(opts->x);
+    if(opts->y) mathi_string_to_lower(opts->y);
+    if(opts->compute) mathi_string_to_lower(opts->compute);
+    if(opts->sort) mathi_string_to_lower(opts->sort);
+    if(opts->bucket) mathi_string_to_lower(opts->bucket);
+    if(opts->profile) mathi_string_to_lower(opts->profile);
+    if(opts->format) mathi_string_to_lower(opts->format);
+    if(opts->mem_limit) mathi_string_to_lower(opts->mem_limit);
+    if(opts->presorted) mathi_string_to_lower(opts->presorted);
+    if(opts->progress) mathi_string_to_lower(opts->progress);
+    if(opts->on) mathi_string_to_lower(opts->on);
+    if(opts->window) mathi_string_to_lower(opts->window);
+    if(opts->cube) mathi_string_to_lower(opts->cube);
+}
+
+// Check the options a bar query cannot run without, 0 when they are fine
+int bar_validate(const BarOptions *opts)
+{
+    if(opts->format && strcmp(opts->format,"json")!=0 && strcmp(opts->format,"chart")!=0)
+    {
+        out_printf("Warning: unknown format '%s'. Using chart.\n", opts->format);
+    }
 
     // Validate required
-    if(!opts.file || !opts.x || !opts.y)
+    if((!opts->file && !opts->data) || !opts->x || !opts->y)
     {
-        printf("Missing required options: file, x, y\n");
-        goto cleanup;
+        out_printf("Missing required options: file (or data), x, y\n");
+        return -1;
     }
 
-    if(!mathi_file_exists(opts.file))
+    if(opts->file && opts->data)
     {
-        printf("Error: file not found -> %s\n", opts.file);
-        goto cleanup;
+        out_printf("Error: use either file or data, not both\n");
+        return -1;
     }
 
-    long fsize=mathi_file_size(opts.file);
-    if(fsize<=0)
+    if(opts->join && !opts->on)
     {
-        printf("Error: file empty or unreadable -> %s\n", opts.file);
-        goto cleanup;
+        out_printf("Error: join needs on= (the key column both files have)\n");
+        return -1;
     }
 
-    // Check header
-    FILE *fp=mathi_filex_open(opts.file,"r");
-    if(!fp)
-    { 
-        printf("Error opening file.\n"); goto cleanup; 
+    if(opts->join && opts->data)
+    {
+        out_printf("Error: join works with file=, not data=\n");
+        return -1;
     }
-    char line[1024];
-    if(!mathi_file_read_line(fp,line,sizeof(line)))
+
+    if(opts->join && !mathi_file_exists(opts->join))
     {
-        printf("Error: cannot read CSV header\n"); mathi_filex_close(fp); goto cleanup;
+        out_printf("Error: file not found -> %s\n", opts->join);
+        return -1;
     }
-    mathi_filex_close(fp);
 
-    int foundX=0,foundY=0;
-    char *token=strtok(line,",");
-    while(token)
+    // a loaded dataset is checked by draw_bar
+    if(opts->data) return 0;
+
+    if(!mathi_file_exists(opts->file))
     {
-        while(*token==' ') token++;
-        char *end=token+strlen(token)-1;
-        while(end>token && (*end==' '||*end=='\n')) *end='\0', end--;
-        if(strcmp(token,opts.x)==0) foundX=1;
-        if(strcmp(token,opts.y)==0) foundY=1;
-        token=strtok(NULL,",");
+        out_printf("Error: file not found -> %s\n", opts->file);
+        return -1;
     }
-    if(!foundX || !foundY)
+
+    long fsize=mathi_file_size(opts->file);
+    if(fsize<=0)
     {
-        printf("Error: columns not found -> x:%s y:%s\n",opts.x,opts.y);
-        goto cleanup;
+        out_printf("Error: file empty or unreadable -> %s\n", opts->file);
+        return -1;
     }
+    return 0;
+}
+
+// Run a query with its statistics, as requested by profile= and format=
+void run_bar(const BarOptions *opts, const BarPlan *plan)
+{
+    // JSON output always carries the stage timings
+    QueryStats stats;
+    stats_init(&stats, option_enabled(opts->profile) || json_output(opts));
 
-    draw_bar(&opts);
+    // header and columns are checked by draw_bar, which opens the file once
+    draw_bar(opts, plan, &stats);
+    if(stats.timing && !json_output(opts) && !cancel_requested()) stats_report(&stats);
+}
 
-cleanup:
-    if(opts.file) free(opts.file);
-    if(opts.x) free(opts.x);
-    if(opts.y) free(opts.y);
-    if(opts.title) free(opts.title);
-    if(opts.compute) free(opts.compute);
-    if(opts.sort) free(opts.sort);
+// Release parsed bar options
+void free_bar_options(BarOptions *opts)
+{
+    free(opts->file);
+    free(opts->data);
+    free(opts->x);
+    free(opts->y);
+    free(opts->title);
+    free(opts->compute);
+    free(opts->sort);
+    free(opts->bucket);
+    free(opts->profile);
+    free(opts->format);
+    free(opts->where);
+    free(opts->mem_limit);
+    free(opts->presorted);
+    free(opts->sample);
+    free(opts->sample_rows);
+    free(opts->progress);
+    free(opts->join);
+    free(opts->on);
+    free(opts->window);
+    free(opts->cube);
+}
+
+// Display bar command
+void display_bar(char *command)
+{
+    BarOptions opts;
+    bar_options(command, &opts);
+    if(bar_validate(&opts)==0) run_bar(&opts, NULL);
+    free_bar_options(&opts);
 }
@@ -0,0 +1,314 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../headers/mathigraphs.h"
+
+// Helper: turn an array chunk into a bitmap chunk, 0 on success
+static int chunk_to_words(BitmapChunk *c)
+{
+    uint64_t *words = calloc(BITMAP_WORDS, sizeof(uint64_t));
+    if (!words) return -1;
+    for (uint32_t i = 0; i < c->card; i++) words[c->array[i] >> 6] |= 1ULL << (c->array[i] & 63);
+    free(c->array);
+    c->array = NULL;
+    c->cap = 0;
+    c->words = words;
+    return 0;
+}
+
+// Helper: turn a bitmap chunk of at most BITMAP_ARRAY_MAX values into an
+// array chunk, 0 on success
+static int chunk_to_array(BitmapChunk *c)
+{
+    uint16_t *array = malloc((c->card ? c->card : 1) * sizeof(uint16_t));
+    if (!array) return -1;
+    uint32_t n = 0;
+    for (uint32_t w = 0; w < BITMAP_WORDS; w++)
+    {
+        for (uint64_t bits = c->words[w]; bits; bits &= bits - 1)
+            array[n++] = (uint16_t)(w * 64 + __builtin_ctzll(bits));
+    }
+    free(c->words);
+    c->words = NULL;
+    c->array = array;
+    c->cap = c->card;
+    return 0;
+}
+
+// Helper: the smaller form for a chunk just filled as a bitmap
+static int chunk_settle(BitmapChunk *c)
+{
+    c->card = 0;
+    for (uint32_t w = 0; w < BITMAP_WORDS; w++) c->card += __builtin_popcountll(c->words[w]);
+    return c->card <= BITMAP_ARRAY_MAX ? chunk_to_array(c) : 0;
+}
+
+// Helper: release a chunk's values
+static void chunk_free(BitmapChunk *c)
+{
+    free(c->array);
+    free(c->words);
+}
+
+// Helper: a copy of a chunk, 0 on success
+static int chunk_copy(const BitmapChunk *a, BitmapChunk *out)
+{
+    *out = *a;
+    if (a->words)
+    {
+        out->words = malloc(BITMAP_WORDS * sizeof(uint64_t));
+        if (!out->words) return -1;
+        memcpy(out->words, a->words, BITMAP_WORDS * sizeof(uint64_t));
+        return 0;
+    }
+    out->cap = a->card;
+    out->array = malloc((a->card ? a->card : 1) * sizeof(uint16_t));
+    if (!out->array) return -1;
+    memcpy(out->array, a->array, a->card * sizeof(uint16_t));
+    return 0;
+}
+
+// Helper: the values two chunks with the same key both hold, 0 on success
+static int chunk_and(const BitmapChunk *a, const BitmapChunk *b, BitmapChunk *out)
+{
+    memset(out, 0, sizeof(*out));
+    out->key = a->key;
+    if (a->words && b->words)
+    {
+        out->words = malloc(BITMAP_WORDS * sizeof(uint64_t));
+        if (!out->words) return -1;
+        for (uint32_t w = 0; w < BITMAP_WORDS; w++) out->words[w] = a->words[w] & b->words[w];
+        return chunk_settle(out);
+    }
+    if (a->words)
+    {
+        const BitmapChunk *t = a;
+        a = b;
+        b = t;
+    }
+
+    // a is an array: the result is no larger
+    out->array = malloc((a->card ? a->card : 1) * sizeof(uint16_t));
+    if (!out->array) return -1;
+    out->cap = a->card;
+    if (b->words)
+    {
+        for (uint32_t i = 0; i < a->card; i++)
+            if (b->words[a->array[i] >> 6] >> (a->array[i] & 63) & 1) out->array[out->card++] = a->array[i];
+        return 0;
+    }
+    uint32_t i = 0, j = 0;
+    while (i < a->card && j < b->card)
+    {
+        if (a->array[i] < b->array[j]) i++;
+        else if (a->array[i] > b->array[j]) j++;
+        else { out->array[out->card++] = a->array[i]; i++; j++; }
+    }
+    return 0;
+}
+
+// Helper: the values either of two chunks with the same key holds, 0 on success
+static int chunk_or(const BitmapChunk *a, const BitmapChunk *b, BitmapChunk *out)
+{
+    memset(out, 0, sizeof(*out));
+    out->key = a->key;
+    if (!a->words && !b->words && a->card + b->card <= BITMAP_ARRAY_MAX)
+    {
+        out->array = malloc((a->card + b->card) * sizeof(uint16_t));
+        if (!out->array) return -1;
+        out->cap = a->card + b->card;
+        uint32_t i = 0, j = 0;
+        while (i < a->card || j < b->card)
+        {
+            if (j == b->card || (i < a->card && a->array[i] < b->array[j])) out->array[out->card++] = a->array[i++];
+            else if (i == a->card || b->array[j] < a->array[i]) out->array[out->card++] = b->array[j++];
+            else { out->array[out->card++] = a->array[i]; i++; j++; }
+        }
+        return 0;
+    }
+
+    out->words = calloc(BITMAP_WORDS, sizeof(uint64_t));
+    if (!out->words) return -1;
+    const BitmapChunk *both[2] = {a, b};
+    for (int k = 0; k < 2; k++)
+    {
+        const BitmapChunk *c = both[k];
+        if (c->words) for (uint32_t w = 0; w < BITMAP_WORDS; w++) out->words[w] |= c->words[w];
+        else for (uint32_t i = 0; i < c->card; i++) out->words[c->array[i] >> 6] |= 1ULL << (c->array[i] & 63);
+    }
+    return chunk_settle(out);
+}
+
+// Helper: add a filled chunk at the end of a bitmap, 0 on success
+static int push_chunk(Bitmap *b, const BitmapChunk *c)
+{
+    if (b->nchunks == b->cap)
+    {
+        int ncap = b->cap ? b->cap * 2 : 4;
+        BitmapChunk *n = realloc(b->chunks, ncap * sizeof(BitmapChunk));
+        if (!n) return -1;
+        b->chunks = n;
+        b->cap = ncap;
+    }
+    b->chunks[b->nchunks++] = *c;
+    return 0;
+}
+
+// Add an id larger than every id the bitmap holds (ids come in row order
+// while an index is built). Returns 0, -1 when out of memory.
+int bitmap_append(Bitmap *b, uint32_t id)
+{
+    uint16_t key = (uint16_t)(id >> 16), low = (uint16_t)id;
+    if (b->nchunks == 0 || b->chunks[b->nchunks - 1].key != key)
+    {
+        BitmapChunk c = {0};
+        c.key = key;
+        if (push_chunk(b, &c) != 0) return -1;
+    }
+
+    BitmapChunk *c = &b->chunks[b->nchunks - 1];
+    if (!c->words && c->card == BITMAP_ARRAY_MAX && chunk_to_words(c) != 0) return -1;
+    if (c->words)
+    {
+        c->words[low >> 6] |= 1ULL << (low & 63);
+        c->card++;
+        return 0;
+    }
+    if (c->card == c->cap)
+    {
+        uint32_t ncap = c->cap ? c->cap * 2 : 16;
+        if (ncap > BITMAP_ARRAY_MAX) ncap = BITMAP_ARRAY_MAX;
+        uint16_t *n = realloc(c->array, ncap * sizeof(uint16_t));
+        if (!n) return -1;
+        c->array = n;
+        c->cap = ncap;
+    }
+    c->array[c->card++] = low;
+    return 0;
+}
+
+// Give back the room left by doubling, once a bitmap is complete
+void bitmap_trim(Bitmap *b)
+{
+    for (int i = 0; i < b->nchunks; i++)
+    {
+        BitmapChunk *c = &b->chunks[i];
+        if (c->words || c->card == c->cap) continue;
+        uint16_t *n = realloc(c->array, c->card * sizeof(uint16_t));
+        if (n) { c->array = n; c->cap = c->card; }
+    }
+    if (b->nchunks > 0 && b->nchunks < b->cap)
+    {
+        BitmapChunk *n = realloc(b->chunks, b->nchunks * sizeof(BitmapChunk));
+        if (n) { b->chunks = n; b->cap = b->nchunks; }
+    }
+}
+
+// The ids both bitmaps hold, into a new bitmap. Only chunks whose keys
+// appear in both are looked at. Returns 0, -1 when out of memory.
+int bitmap_and(const Bitmap *a, const Bitmap *b, Bitmap *out)
+{
+    memset(out, 0, sizeof(*out));
+    int i = 0, j = 0;
+    while (i < a->nchunks && j < b->nchunks)
+    {
+        if (a->chunks[i].key < b->chunks[j].key) { i++; continue; }
+        if (a->chunks[i].key > b->chunks[j].key) { j++; continue; }
+        BitmapChunk c;
+        if (chunk_and(&a->chunks[i++], &b->chunks[j++], &c) != 0 || (c.card > 0 && push_chunk(out, &c) != 0))
+        {
+            chunk_free(&c);
+            bitmap_free(out);
+            return -1;
+        }
+        if (c.card == 0) chunk_free(&c);
+    }
+    return 0;
+}
+
+// The ids either bitmap holds, into a new bitmap. Returns 0, -1 when out
+// of memory.
+int bitmap_or(const Bitmap *a, const Bitmap *b, Bitmap *out)
+{
+    memset(out, 0, sizeof(*out));
+    int i = 0, j = 0;
+    while (i < a->nchunks || j < b->nchunks)
+    {
+        BitmapChunk c;
+        int rc;
+        if (j == b->nchunks || (i < a->nchunks && a->chunks[i].key < b->chunks[j].key)) rc = chunk_copy(&a->chunks[i++], &c);
+        else if (i == a->nchunks || b->chunks[j].key < a->chunks[i].key) rc = chunk_copy(&b->chunks[j++], &c);
+        else rc = chunk_or(&a->chunks[i++], &b->chunks[j++], &c);
+        if (rc != 0 || push_chunk(out, &c) != 0)
+        {
+            chunk_free(&c);
+            bitmap_free(out);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Number of ids held
+long bitmap_count(const Bitmap *b)
+{
+    long n = 0;
+    for (int i = 0; i < b->nchunks; i++) n += b->chunks[i].card;
+    return n;
+}
+
+// Heap held by the bitmap
+size_t bitmap_bytes(const Bitmap *b)
+{
+    size_t n = b->cap * sizeof(BitmapChunk);
+    for (int i = 0; i < b->nchunks; i++)
+        n += b->chunks[i].words ? BITMAP_WORDS * sizeof(uint64_t) : b->chunks[i].cap * sizeof(uint16_t);
+    return n;
+}
+
+// Start a walk over the ids of a bitmap
+void bitmap_iter(BitmapIter *it, const Bitmap *b)
+{
+    it->b = b;
+    it->chunk = 0;
+    it->pos = 0;
+}
+
+// The next id of the walk, -1 after the last. A bitmap chunk skips its
+// empty words 64 ids at a time.
+long bitmap_next(BitmapIter *it)
+{
+    while (it->chunk < it->b->nchunks)
+    {
+        const BitmapChunk *c = &it->b->chunks[it->chunk];
+        long high = (long)c->key << 16;
+        if (!c->words)
+        {
+            if (it->pos < c->card) return high | c->array[it->pos++];
+        }
+        else
+        {
+            while (it->pos < 65536)
+            {
+                uint64_t bits = c->words[it->pos >> 6] >> (it->pos & 63);
+                if (bits)
+                {
+                    it->pos += __builtin_ctzll(bits);
+                    return high | it->pos++;
+                }
+                it->pos = (it->pos | 63) + 1;
+            }
+        }
+        it->chunk++;
+        it->pos = 0;
+    }
+    return -1;
+}
+
+// Release the chunks
+void bitmap_free(Bitmap *b)
+{
+    for (int i = 0; i < b->nchunks; i++) chunk_free(&b->chunks[i]);
+    free(b->chunks);
+    memset(b, 0, sizeof(*b));
+}
@@ -0,0 +1,45 @@
+#include <signal.h>
+#include <string.h>
+#include "../headers/mathigraphs.h"
+
+// Set by SIGINT, polled by the scan loops. Scans stop at their next
+// checkpoint, free what they built and return without output.
+static volatile sig_atomic_t cancelled;
+
+// Helper: first Ctrl-C asks the running command to stop; a second one before
+// the flag is cleared (a scan without checkpoints, or at an idle prompt)
+// quits the process the usual way.
+static void on_interrupt(int sig)
+{
+    if (cancelled)
+    {
+        signal(sig, SIG_DFL);
+        raise(sig);
+        return;
+    }
+    cancelled = 1;
+}
+
+// Catch Ctrl-C for the interactive prompt. Reads are restarted, so the
+// prompt keeps waiting for input instead of failing.
+void cancel_install(void)
+{
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_interrupt;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+}
+
+// True once Ctrl-C was pressed during the current command
+int cancel_requested(void)
+{
+    return cancelled;
+}
+
+// Forget a handled Ctrl-C, done after every command
+void cancel_clear(void)
+{
+    cancelled = 0;
+}
@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <string.h>
+#include "../headers/mathigraphs.h"
+
+// Run one command line (lowercased in place), shared by the REPL and the
+// server. Returns 1 when the command asks to end the session.
+int run_command(char *line)
+{
+    char *user_inp = mathi_string_to_lower(line);
+    int quit = 0;
+    cancel_clear(); // a Ctrl-C at the idle prompt is not for this command
+
+    // per-command memory accounting, see memstats
+    int tracked = mem_tracking_enabled();
+    if (tracked) mem_reset();
+
+    if (mathi_string_compare(user_inp, "help") == 0)
+    {
+        bar_help();
+        hist_help();
+        line_help();
+        scatter_help();
+        pivot_help();
+        rollup_help();
+        dataset_help();
+        prepare_help();
+    }
+    else if (mathi_string_compare(user_inp, "exit") == 0)
+    {
+        out_printf("Bye!\n");
+        quit = 1;
+    }
+    else if (strncmp(user_inp, "memstats", 8) == 0)
+    {
+        if (strstr(user_inp, "off")) mem_tracking(0);
+        else mem_tracking(1);
+        out_printf("Memory accounting %s\n", mem_tracking_enabled() ? "on" : "off");
+    }
+    else if (mathi_string_compare(user_inp, "datasets") == 0)
+    {
+        display_datasets();
+    }
+    else if (strncmp(user_inp, "load", 4) == 0)
+    {
+        display_load(user_inp);
+    }
+    else if (strncmp(user_inp, "schema", 6) == 0)
+    {
+        display_schema(user_inp);
+    }
+    else if (strncmp(user_inp, "unload", 6) == 0)
+    {
+        display_unload(user_inp);
+    }
+    else if (strncmp(user_inp, "prepare", 7) == 0)
+    {
+        display_prepare(user_inp);
+    }
+    else if (strncmp(user_inp, "run", 3) == 0)
+    {
+        display_run(user_inp);
+    }
+    else if (strncmp(user_inp, "bar", 3) == 0)
+    {
+        display_bar(user_inp);
+    }
+    else if (strncmp(user_inp, "hist", 4) == 0)
+    {
+        display_hist(user_inp);
+    }
+    else if (strncmp(user_inp, "pivot", 5) == 0)
+    {
+        display_pivot(user_inp);
+    }
+    else if (strncmp(user_inp, "rollup", 6) == 0)
+    {
+        display_rollup(user_inp);
+    }
+    else if (strncmp(user_inp, "line", 4) == 0)
+    {
+        display_line(user_inp);
+    }
+    else if (strncmp(user_inp, "scatter", 7) == 0)
+    {
+        display_scatter(user_inp);
+    }
+    else
+    {
+        out_printf("Invalid command. Type help to see commands\n");
+    }
+
+    // a Ctrl-C during the command stopped it at its next checkpoint
+    if (cancel_requested())
+    {
+        out_printf("Cancelled.\n");
+        cancel_clear();
+    }
+
+    if (tracked && mem_tracking_enabled())
+    {
+        MemStats mem;
+        mem_snapshot(&mem);
+        mem_report(&mem);
+    }
+    return quit;
+}
@@ -0,0 +1,317 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/stat.h>
+#include "../headers/mathigraphs.h"
+
+// Helper: strip spaces and line endings around a field in place
+static char *trim_field(char *s)
+{
+    while (*s == ' ' || *s == '\t') s++;
+    char *end = s + strlen(s);
+    while (end > s && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\n' || end[-1] == '\r')) end--;
+    *end = '\0';
+    return s;
+}
+
+// Helper: append a field pointer, growing the array as needed
+static int push_field(CsvReader *r, char *field)
+{
+    if (r->nfields == r->fcap)
+    {
+        int ncap = r->fcap ? r->fcap * 2 : 16;
+        char **nf = realloc(r->fields, ncap * sizeof(char *));
+        if (!nf) return -1;
+        r->fields = nf;
+        r->fcap = ncap;
+    }
+    r->fields[r->nfields++] = field;
+    return 0;
+}
+
+// Helper: split the current line on commas into r->fields (fast path, no quotes)
+static int split_line(CsvReader *r)
+{
+    r->nfields = 0;
+    char *p = r->line;
+    while (1)
+    {
+        char *comma = strchr(p, ',');
+        if (comma) *comma = '\0';
+        if (push_field(r, trim_field(p)) != 0) return -1;
+        if (!comma) break;
+        p = comma + 1;
+    }
+    return r->nfields;
+}
+
+// Helper: split a record containing RFC 4180 quoted fields. Quotes only open
+// a field at its start; "" inside a quoted field is one quote. Fields are
+// unescaped in place, which is safe because the write position never passes
+// the read position.
+static int split_quoted(CsvReader *r)
+{
+    r->nfields = 0;
+    char *p = r->line, *w = r->line;
+    while (1)
+    {
+        while (*p == ' ' || *p == '\t') p++;
+        char *start = w;
+        if (*p == '"')
+        {
+            p++;
+            while (*p)
+            {
+                if (*p == '"')
+                {
+                    if (p[1] != '"') { p++; break; }
+                    p++;
+                }
+                *w++ = *p++;
+            }
+            // stray text between the closing quote and the comma is kept, blanks are not
+            while (*p && *p != ',')
+            {
+                if (*p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') *w++ = *p;
+                p++;
+            }
+        }
+        else
+        {
+            while (*p && *p != ',') *w++ = *p++;
+            while (w > start && (w[-1] == ' ' || w[-1] == '\t' || w[-1] == '\r' || w[-1] == '\n')) w--;
+        }
+
+        int more = *p == ',';
+        if (more) p++;
+        *w++ = '\0';
+        if (push_field(r, start) != 0) return -1;
+        if (!more) break;
+    }
+    return r->nfields;
+}
+
+// Helper: advance the quote state machine over s[0..len), returns the new state
+// (0 field start, 1 unquoted, 2 inside quotes, 3 just after a quote in quotes)
+static int scan_quotes(const char *s, size_t len, int st)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        char c = s[i];
+        switch (st)
+        {
+            case 0: st = c == '"' ? 2 : (c == ',' || c == ' ' || c == '\t') ? 0 : 1; break;
+            case 1: st = c == ',' ? 0 : 1; break;
+            case 2: st = c == '"' ? 3 : 2; break;
+            case 3: st = c == '"' ? 2 : c == ',' ? 0 : 1; break;
+        }
+    }
+    return st;
+}
+
+// Helper: read one physical line, returns its length or -1 at EOF
+static long read_line(CsvReader *r)
+{
+    ssize_t len = getline(&r->line, &r->cap, r->fp);
+    if (len < 0) return -1;
+    r->bytes += len;
+    r->len = len;
+    return len;
+}
+
+// Helper: read one record into r->line without splitting it: 0 for a plain
+// line, 1 when it has quotes, -1 at EOF. Only quoted records pay for the
+// state machine and for joining lines when a quoted field contains newlines.
+static int read_raw(CsvReader *r)
+{
+    if (read_line(r) < 0) return -1;
+    if (!memchr(r->line, '"', r->len)) return 0;
+
+    int st = scan_quotes(r->line, r->len, 0);
+    while (st == 2)
+    {
+        ssize_t more = getline(&r->extra, &r->extra_cap, r->fp);
+        if (more < 0) break; // unterminated quote: take what we have
+        r->bytes += more;
+        if (r->len + more + 1 > r->cap)
+        {
+            size_t ncap = (r->len + more + 1) * 2;
+            char *nl = realloc(r->line, ncap);
+            if (!nl) return -1;
+            r->line = nl;
+            r->cap = ncap;
+        }
+        memcpy(r->line + r->len, r->extra, more + 1);
+        st = scan_quotes(r->line + r->len, more, st);
+        r->len += more;
+    }
+    return 1;
+}
+
+// Helper: read one record and split it; plain lines take the fast comma split
+static int read_record(CsvReader *r)
+{
+    int quoted = read_raw(r);
+    if (quoted < 0) return -1;
+    return quoted ? split_quoted(r) : split_line(r);
+}
+
+// Open a CSV file and read its header row
+int csv_open(CsvReader *r, const char *path)
+{
+    if (csv_open_file(r, path) != 0) return -1;
+    return csv_read_header(r);
+}
+
+// Say why csv_open failed with rc: -2 for a file without a header row,
+// -1 when it could not be opened
+void csv_open_error(int rc, const char *path)
+{
+    if (rc == -2) out_printf("Error: empty file\n");
+    else out_printf("Error: could not open file: %s\n", path);
+}
+
+// Open a CSV file without reading anything yet
+int csv_open_file(CsvReader *r, const char *path)
+{
+    memset(r, 0, sizeof(*r));
+    r->fp = fopen(path, "r");
+    return r->fp ? 0 : -1;
+}
+
+// Read the header row of a freshly opened file
+int csv_read_header(CsvReader *r)
+{
+    if (read_record(r) <= 0)
+    {
+        csv_close(r);
+        return -2;
+    }
+
+    r->header = malloc(r->nfields * sizeof(char *));
+    if (!r->header)
+    {
+        csv_close(r);
+        return -1;
+    }
+    for (int i = 0; i < r->nfields; i++)
+    {
+        r->header[i] = strdup(r->fields[i]);
+        mathi_string_to_lower(r->header[i]);
+    }
+    r->ncols = r->nfields;
+    return 0;
+}
+
+// Read the next data row, returns number of fields or -1 at EOF (or when
+// the command was cancelled, see cancel_requested)
+int csv_next(CsvReader *r)
+{
+    int nf;
+    if (cancel_requested()) return -1; // Ctrl-C: end the scan early
+    while ((nf = read_record(r)) >= 0)
+    {
+        // blank lines are not rows
+        if (nf == 1 && r->fields[0][0] == '\0') continue;
+        r->rows++;
+        return nf;
+    }
+    return -1;
+}
+
+// Pass over the next data row without splitting it, for rows a sample does
+// not keep. Returns 0, or -1 at EOF (or when the command was cancelled).
+int csv_skip(CsvReader *r)
+{
+    if (cancel_requested()) return -1;
+    while (read_raw(r) >= 0)
+    {
+        // blank lines are not rows
+        size_t i = 0;
+        while (i < r->len && (r->line[i] == ' ' || r->line[i] == '\t' || r->line[i] == '\r' || r->line[i] == '\n')) i++;
+        if (i == r->len) continue;
+        r->rows++;
+        return 0;
+    }
+    return -1;
+}
+
+// Move to the first record that starts at or after a file offset past the
+// header, by finishing the line that holds offset - 1. *pos gets the offset
+// reached. A quoted field with newlines inside can make the reader start
+// mid-record; callers that sample blocks accept that.
+int csv_seek_record(CsvReader *r, long long offset, long long *pos)
+{
+    if (fseeko(r->fp, offset - 1, SEEK_SET) != 0) return -1;
+    ssize_t len = getline(&r->extra, &r->extra_cap, r->fp);
+    if (len < 0) return -1;
+    *pos = offset - 1 + len;
+    return 0;
+}
+
+// Find a column index by (lowercase) name, -1 if missing
+int csv_find_column(const CsvReader *r, const char *name)
+{
+    for (int i = 0; i < r->ncols; i++)
+        if (strcmp(r->header[i], name) == 0) return i;
+    return -1;
+}
+
+// Parse a whole field as a number, 0 if it is not one
+int csv_number(const char *s, double *out)
+{
+    char *endptr;
+    *out = strtod(s, &endptr);
+    return endptr != s && *endptr == '\0';
+}
+
+// Order of two labels for sorting: numbers first, by value, then text by
+// strcmp (nan counts as text). Unlike comparing as numbers only when both
+// labels are, this is a total order for any mix, so qsort can use it.
+int csv_label_order(const char *a, const char *b)
+{
+    double x, y;
+    int na = csv_number(a, &x) && !isnan(x), nb = csv_number(b, &y) && !isnan(y);
+    if (na != nb) return na ? -1 : 1;
+    if (na && x != y) return x < y ? -1 : 1;
+    return strcmp(a, b);
+}
+
+// Go back to the first data row for another pass
+int csv_rewind(CsvReader *r)
+{
+    if (fseek(r->fp, 0, SEEK_SET) != 0) return -1;
+    r->rows = 0;
+    r->bytes = 0;
+    return read_record(r) < 0 ? -1 : 0;
+}
+
+// Size and modification time of a file, to tell when cached facts about it
+// (header, schema) are stale. Returns 0 on success.
+int csv_fingerprint(const char *path, CsvFingerprint *fp)
+{
+    struct stat st;
+    if (stat(path, &st) != 0) return -1;
+    fp->size = st.st_size;
+    fp->mtime_ns = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+    return 0;
+}
+
+// True when two fingerprints describe the same file contents
+int csv_same_file(const CsvFingerprint *a, const CsvFingerprint *b)
+{
+    return a->size == b->size && a->mtime_ns == b->mtime_ns;
+}
+
+// Release everything held by the reader
+void csv_close(CsvReader *r)
+{
+    if (r->fp) fclose(r->fp);
+    for (int i = 0; i < r->ncols; i++) free(r->header[i]);
+    free(r->header);
+    free(r->line);
+    free(r->extra);
+    free(r->fields);
+    memset(r, 0, sizeof(*r));
+}
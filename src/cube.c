@@ -0,0 +1,575 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../headers/mathigraphs.h"
+
+#define CUBE_MAGIC "MGCUBE1\n"
+
+// Layout of a cube file, all integers little-endian as written:
+//   magic, source size and mtime (int64 each), y name,
+//   dimension count (uint32) and names,
+//   per dimension its dictionary: value count (uint32), the bytes of the
+//   values that follow (int64, to step over it) and the values,
+//   combination count (uint32) and per combination {mask, groups, offset},
+//   per combination its groups: the dimension codes (uint32 each, in
+//   dimension order) followed by a CubeRecord.
+// Strings are a uint32 length and the bytes, without a terminator.
+
+// Aggregates of one group as stored after its codes
+typedef struct {
+    double sum;
+    double sumsq;
+    double min;
+    double max;
+    int64_t count;
+    int64_t first;      // data row the group first shows up in
+} CubeRecord;
+
+// One entry of the combination directory
+typedef struct {
+    uint32_t mask;      // bit d set when dimension d is part of it
+    uint32_t count;     // groups stored
+    int64_t offset;     // file offset of the first group
+} CubeEntry;
+
+// A combination being rolled up: groups keyed by their packed dimension
+// codes in an open-addressing table
+typedef struct {
+    uint32_t mask;
+    int k;
+    int dims[CUBE_MAX_DEPTH];
+    uint64_t *keys;
+    Group *groups;
+    int64_t *first;
+    long count;
+    long cap;
+    long *table;        // group index per slot, -1 when empty
+    size_t tcap;        // a power of two, kept at least twice count
+} CubeSet;
+
+// Helper: the file a rollup of path is written to
+static char *cube_path(const char *file)
+{
+    size_t n = strlen(file);
+    char *path = malloc(n + 6);
+    if (path) { memcpy(path, file, n); memcpy(path + n, ".cube", 6); }
+    return path;
+}
+
+// Helper: mix a packed key for the table
+static size_t key_hash(uint64_t key)
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return (size_t)key;
+}
+
+// Helper: the group of a packed key, added as first seen in row when new;
+// NULL when out of memory
+static Group *set_get(CubeSet *s, uint64_t key, int64_t row)
+{
+    if ((size_t)s->count * 2 >= s->tcap)
+    {
+        size_t ncap = s->tcap ? s->tcap * 2 : 64;
+        long *nt = malloc(ncap * sizeof(long));
+        if (!nt) return NULL;
+        memset(nt, 0xff, ncap * sizeof(long)); // all -1
+        for (long i = 0; i < s->count; i++)
+        {
+            size_t h = key_hash(s->keys[i]) & (ncap - 1);
+            while (nt[h] != -1) h = (h + 1) & (ncap - 1);
+            nt[h] = i;
+        }
+        free(s->table);
+        s->table = nt;
+        s->tcap = ncap;
+    }
+
+    size_t h = key_hash(key) & (s->tcap - 1);
+    while (s->table[h] != -1 && s->keys[s->table[h]] != key) h = (h + 1) & (s->tcap - 1);
+    if (s->table[h] != -1) return &s->groups[s->table[h]];
+
+    if (s->count == s->cap)
+    {
+        long ncap = s->cap ? s->cap * 2 : 64;
+        uint64_t *keys = realloc(s->keys, ncap * sizeof(uint64_t));
+        if (!keys) return NULL;
+        s->keys = keys;
+        Group *groups = realloc(s->groups, ncap * sizeof(Group));
+        if (!groups) return NULL;
+        s->groups = groups;
+        int64_t *first = realloc(s->first, ncap * sizeof(int64_t));
+        if (!first) return NULL;
+        s->first = first;
+        s->cap = ncap;
+    }
+    s->keys[s->count] = key;
+    s->first[s->count] = row;
+    memset(&s->groups[s->count], 0, sizeof(Group));
+    s->table[h] = s->count;
+    return &s->groups[s->count++];
+}
+
+// Helper: split dims= into at most CUBE_MAX_DIMS distinct names (owned by
+// the caller). Returns the count, -1 with a message when invalid.
+static int parse_dims(const char *spec, char **names)
+{
+    int n = 0;
+    const char *p = spec;
+    while (*p)
+    {
+        while (*p == ' ' || *p == ',') p++;
+        if (!*p) break;
+        const char *end = p;
+        while (*end && *end != ',') end++;
+        size_t len = end - p;
+        while (len > 0 && p[len - 1] == ' ') len--;
+        if (n == CUBE_MAX_DIMS)
+        {
+            out_printf("Error: a rollup takes at most %d dims\n", CUBE_MAX_DIMS);
+            for (int i = 0; i < n; i++) free(names[i]);
+            return -1;
+        }
+        names[n] = strndup(p, len);
+        for (int i = 0; i < n; i++)
+        {
+            if (strcmp(names[i], names[n]) == 0)
+            {
+                out_printf("Error: dim '%s' is named twice\n", names[n]);
+                for (int j = 0; j <= n; j++) free(names[j]);
+                return -1;
+            }
+        }
+        n++;
+        p = end;
+    }
+    if (n == 0) out_printf("Error: dims= names no columns\n");
+    return n > 0 ? n : -1;
+}
+
+// A group of the answer and the first row it came from
+typedef struct {
+    Group g;
+    int64_t first;
+} CubeHit;
+
+// Helper: qsort comparator putting hits in the order bar meets their rows
+static int hit_order(const void *a, const void *b)
+{
+    int64_t fa = ((const CubeHit *)a)->first, fb = ((const CubeHit *)b)->first;
+    return (fa > fb) - (fa < fb);
+}
+
+// Helper: write a length-prefixed string, 0 on success
+static int write_text(FILE *f, const char *s)
+{
+    uint32_t len = (uint32_t)strlen(s);
+    return fwrite(&len, sizeof(len), 1, f) == 1 && fwrite(s, 1, len, f) == len ? 0 : -1;
+}
+
+// Helper: read a length-prefixed string into a new buffer, NULL on failure
+static char *read_text(FILE *f)
+{
+    uint32_t len;
+    if (fread(&len, sizeof(len), 1, f) != 1 || len > (1u << 24)) return NULL;
+    char *s = malloc(len + 1);
+    if (!s) return NULL;
+    if (fread(s, 1, len, f) != len) { free(s); return NULL; }
+    s[len] = '\0';
+    return s;
+}
+
+// Helper: write the cube to path through a temporary file, so a reader never
+// sees half of one. Returns the bytes written, -1 with a message on failure.
+static long long write_cube(const char *path, const CsvFingerprint *fp, const char *y, char **dims, int ndims,
+                            GroupTable *dicts, CubeSet *sets, int nsets)
+{
+    size_t n = strlen(path);
+    char *tmp = malloc(n + 5);
+    if (!tmp) { out_printf("Error: out of memory\n"); return -1; }
+    memcpy(tmp, path, n);
+    memcpy(tmp + n, ".tmp", 5);
+    FILE *f = fopen(tmp, "wb");
+    if (!f)
+    {
+        out_printf("Error: could not create %s\n", tmp);
+        free(tmp);
+        return -1;
+    }
+
+    int64_t size = fp->size, mtime = fp->mtime_ns;
+    uint32_t nd = ndims, ns = nsets;
+    int ok = fwrite(CUBE_MAGIC, 1, 8, f) == 8 && fwrite(&size, sizeof(size), 1, f) == 1 &&
+             fwrite(&mtime, sizeof(mtime), 1, f) == 1 && write_text(f, y) == 0 && fwrite(&nd, sizeof(nd), 1, f) == 1;
+    for (int d = 0; ok && d < ndims; d++) ok = write_text(f, dims[d]) == 0;
+    for (int d = 0; ok && d < ndims; d++)
+    {
+        uint32_t count = dicts[d].gcount;
+        int64_t dictBytes = 0;
+        for (int i = 0; i < dicts[d].gcount; i++) dictBytes += sizeof(uint32_t) + strlen(dicts[d].groups[i].label);
+        ok = fwrite(&count, sizeof(count), 1, f) == 1 && fwrite(&dictBytes, sizeof(dictBytes), 1, f) == 1;
+        for (int i = 0; ok && i < dicts[d].gcount; i++) ok = write_text(f, dicts[d].groups[i].label) == 0;
+    }
+    ok = ok && fwrite(&ns, sizeof(ns), 1, f) == 1;
+
+    // the groups start right after the directory
+    int64_t offset = ok ? ftell(f) + (long)nsets * sizeof(CubeEntry) : 0;
+    for (int i = 0; ok && i < nsets; i++)
+    {
+        CubeEntry e = {sets[i].mask, (uint32_t)sets[i].count, offset};
+        ok = fwrite(&e, sizeof(e), 1, f) == 1;
+        offset += sets[i].count * (sets[i].k * sizeof(uint32_t) + sizeof(CubeRecord));
+    }
+    for (int i = 0; ok && i < nsets; i++)
+    {
+        const CubeSet *s = &sets[i];
+        for (long g = 0; ok && g < s->count; g++)
+        {
+            uint32_t codes[CUBE_MAX_DEPTH];
+            for (int j = 0; j < s->k; j++) codes[j] = (uint32_t)(s->keys[g] >> (CUBE_CODE_BITS * j)) & CUBE_MAX_CODES;
+            const Group *grp = &s->groups[g];
+            CubeRecord rec = {grp->sum, grp->sumsq, grp->min, grp->max, grp->count, s->first[g]};
+            ok = fwrite(codes, sizeof(uint32_t), s->k, f) == (size_t)s->k && fwrite(&rec, sizeof(rec), 1, f) == 1;
+        }
+    }
+    long long bytes = ok ? ftell(f) : -1;
+    if (fclose(f) != 0) ok = 0;
+    if (!ok || rename(tmp, path) != 0)
+    {
+        out_printf("Error: could not write %s (disk full?)\n", path);
+        remove(tmp);
+        bytes = -1;
+    }
+    free(tmp);
+    return bytes;
+}
+
+// Helper: aggregate y of every row for each combination of 1 to depth dims
+// in one scan, then write the cube next to the file
+static void rollup(const RollupOptions *opts, char **dims, int ndims, int depth)
+{
+    CsvReader csv;
+    int rc = csv_open(&csv, opts->file);
+    if (rc != 0)
+    {
+        csv_open_error(rc, opts->file);
+        return;
+    }
+    CsvFingerprint fp;
+    char *path = cube_path(opts->file);
+    GroupTable dicts[CUBE_MAX_DIMS] = {{0}};
+    CubeSet *sets = NULL;
+    int nsets = 0, failed = 0;
+    int cols[CUBE_MAX_DIMS];
+    int colY = csv_find_column(&csv, opts->y);
+    for (int d = 0; d < ndims; d++)
+    {
+        cols[d] = csv_find_column(&csv, dims[d]);
+        if (cols[d] == -1)
+        {
+            out_printf("Error: column not found -> %s\n", dims[d]);
+            goto cleanup;
+        }
+    }
+    if (colY == -1)
+    {
+        out_printf("Error: column not found -> %s\n", opts->y);
+        goto cleanup;
+    }
+    if (!path || csv_fingerprint(opts->file, &fp) != 0)
+    {
+        out_printf("Error: out of memory\n");
+        goto cleanup;
+    }
+
+    // every combination of 1 to depth dims, smallest first
+    sets = calloc(1u << ndims, sizeof(CubeSet));
+    if (!sets) { out_printf("Error: out of memory\n"); goto cleanup; }
+    for (int k = 1; k <= depth; k++)
+    {
+        for (uint32_t mask = 1; mask < (1u << ndims); mask++)
+        {
+            if (__builtin_popcount(mask) != k) continue;
+            CubeSet *s = &sets[nsets++];
+            s->mask = mask;
+            for (int d = 0; d < ndims; d++) if (mask & (1u << d)) s->dims[s->k++] = d;
+        }
+    }
+
+    SchemaType *types = malloc(csv.ncols * sizeof(SchemaType));
+    SchemaType typeY = SCHEMA_EMPTY;
+    if (types && schema_get(opts->file, types, csv.ncols) == 0) typeY = types[colY];
+    free(types);
+
+    // a row too short for a dim still counts toward the combinations
+    // without it, as bar would count it
+    long used = 0, rejected = 0;
+    int nf;
+    double v;
+    while (!failed && (nf = csv_next(&csv)) >= 0)
+    {
+        if (colY >= nf || !schema_number(typeY, csv.fields[colY], &v))
+        {
+            rejected++;
+            continue;
+        }
+        int64_t codes[CUBE_MAX_DIMS];
+        for (int d = 0; d < ndims; d++)
+        {
+            codes[d] = -1;
+            if (cols[d] >= nf) continue;
+            Group *g = group_table_get(&dicts[d], csv.fields[cols[d]]);
+            if (!g) { out_printf("Error: out of memory\n"); failed = 1; break; }
+            codes[d] = g - dicts[d].groups;
+            if (codes[d] > CUBE_MAX_CODES)
+            {
+                out_printf("Error: %s has more than %d distinct values\n", dims[d], CUBE_MAX_CODES);
+                failed = 1;
+                break;
+            }
+        }
+        for (int i = 0; !failed && i < nsets; i++)
+        {
+            const CubeSet *s = &sets[i];
+            uint64_t key = 0;
+            int j;
+            for (j = 0; j < s->k && codes[s->dims[j]] >= 0; j++) key |= (uint64_t)codes[s->dims[j]] << (CUBE_CODE_BITS * j);
+            if (j < s->k) continue;
+            Group *g = set_get(&sets[i], key, csv.rows);
+            if (!g) { out_printf("Error: out of memory\n"); failed = 1; break; }
+            group_add(g, v);
+        }
+        used++;
+    }
+    if (failed || cancel_requested()) goto cleanup;
+
+    long long bytes = write_cube(path, &fp, opts->y, dims, ndims, dicts, sets, nsets);
+    if (bytes < 0) goto cleanup;
+    long groups = 0;
+    for (int i = 0; i < nsets; i++) groups += sets[i].count;
+    out_printf("Rolled up %ld rows of '%s' into %s: %d dims, %d combinations, %ld groups, %.1f MB\n",
+               used, opts->file, path, ndims, nsets, groups, bytes / 1048576.0);
+    if (rejected > 0) out_printf("(%ld rows without a numeric %s skipped)\n", rejected, opts->y);
+
+cleanup:
+    for (int i = 0; i < nsets; i++)
+    {
+        free(sets[i].keys);
+        free(sets[i].groups);
+        free(sets[i].first);
+        free(sets[i].table);
+    }
+    free(sets);
+    for (int d = 0; d < ndims; d++) group_table_free(&dicts[d]);
+    free(path);
+    csv_close(&csv);
+}
+
+// Answer a bar-style query (y of each x, over the rows where matches) from
+// the rollup of file, when there is an up-to-date one whose y is this y and
+// which holds the combination of x and the where columns. Fills *out with
+// the groups in the order the file first shows their x, adds the cube bytes
+// read to *bytes and returns the group count; -1 when the file has to be
+// scanned instead (a stale cube is reported).
+int cube_query(const char *file, const char *x, const char *y, const char *where, Group **out, long long *bytes)
+{
+    char *path = cube_path(file);
+    FILE *f = path ? fopen(path, "rb") : NULL;
+    if (!f)
+    {
+        free(path);
+        return -1;
+    }
+
+    int result = -1;
+    char magic[8];
+    int64_t size, mtime;
+    uint32_t ndims = 0, nsets = 0;
+    long long skipped = 0;
+    char *cubeY = NULL;
+    char *names[CUBE_MAX_DIMS] = {0};
+    char **dicts[CUBE_MAX_DIMS] = {0};
+    uint32_t ndict[CUBE_MAX_DIMS] = {0};
+    CubeEntry *dir = NULL;
+    CubeHit *byCode = NULL;
+    Group *groups = NULL;
+    Where w = {0};
+    CsvFingerprint now;
+    if (fread(magic, 1, 8, f) != 8 || memcmp(magic, CUBE_MAGIC, 8) != 0 || fread(&size, sizeof(size), 1, f) != 1 ||
+        fread(&mtime, sizeof(mtime), 1, f) != 1 || csv_fingerprint(file, &now) != 0)
+        goto cleanup;
+    CsvFingerprint then = {size, mtime};
+    if (!csv_same_file(&then, &now))
+    {
+        out_printf("Warning: %s is older than %s; scanning the file (run rollup again)\n", path, file);
+        goto cleanup;
+    }
+    if (!(cubeY = read_text(f)) || strcmp(cubeY, y) != 0) goto cleanup;
+    if (fread(&ndims, sizeof(ndims), 1, f) != 1 || ndims > CUBE_MAX_DIMS) goto cleanup;
+    for (uint32_t d = 0; d < ndims; d++) if (!(names[d] = read_text(f))) goto cleanup;
+
+    // the combination needed: x and every column where= names
+    uint32_t mask = 0;
+    int xd = -1;
+    for (uint32_t d = 0; d < ndims; d++) if (strcmp(names[d], x) == 0) xd = d;
+    if (xd == -1) goto cleanup;
+    mask = 1u << xd;
+    if (where)
+    {
+        // quietly: a where= the cube cannot take is reported by the scan
+        if (where_parse(where, &w) != 0) goto cleanup;
+        for (int i = 0; i < w.nterms; i++)
+        {
+            uint32_t d = 0;
+            while (d < ndims && strcmp(names[d], w.terms[i].column) != 0) d++;
+            if (d == ndims) goto cleanup;
+            mask |= 1u << d;
+        }
+    }
+
+    // only the dictionaries of the combination's dims are kept
+    for (uint32_t d = 0; d < ndims; d++)
+    {
+        int64_t dictBytes;
+        if (fread(&ndict[d], sizeof(uint32_t), 1, f) != 1 || ndict[d] > CUBE_MAX_CODES + 1u ||
+            fread(&dictBytes, sizeof(dictBytes), 1, f) != 1)
+            goto cleanup;
+        if (!(mask & (1u << d)))
+        {
+            if (fseek(f, dictBytes, SEEK_CUR) != 0) goto cleanup;
+            skipped += dictBytes;
+            ndict[d] = 0;
+            continue;
+        }
+        dicts[d] = calloc(ndict[d] ? ndict[d] : 1, sizeof(char *));
+        if (!dicts[d]) goto cleanup;
+        for (uint32_t i = 0; i < ndict[d]; i++) if (!(dicts[d][i] = read_text(f))) goto cleanup;
+    }
+    if (fread(&nsets, sizeof(nsets), 1, f) != 1 || nsets >= (1u << CUBE_MAX_DIMS)) goto cleanup;
+    dir = malloc((nsets ? nsets : 1) * sizeof(CubeEntry));
+    if (!dir || fread(dir, sizeof(CubeEntry), nsets, f) != nsets) goto cleanup;
+    *bytes += ftell(f) - skipped;
+    uint32_t e = 0;
+    while (e < nsets && dir[e].mask != mask) e++;
+    if (e == nsets) goto cleanup;
+
+    // the set's columns in file order stand in for the header of its rows
+    int k = 0, dims[CUBE_MAX_DEPTH], xi = 0;
+    char *setNames[CUBE_MAX_DEPTH];
+    for (uint32_t d = 0; d < ndims; d++)
+    {
+        if (!(mask & (1u << d))) continue;
+        if (d == (uint32_t)xd) xi = k;
+        setNames[k] = names[d];
+        dims[k++] = d;
+    }
+    if (w.nclauses > 0 && where_bind(&w, setNames, k) != 0) goto cleanup;
+
+    byCode = calloc(ndict[xd] ? ndict[xd] : 1, sizeof(CubeHit));
+    if (!byCode || fseek(f, dir[e].offset, SEEK_SET) != 0) goto cleanup;
+    for (uint32_t g = 0; g < dir[e].count; g++)
+    {
+        uint32_t codes[CUBE_MAX_DEPTH];
+        CubeRecord rec;
+        if (fread(codes, sizeof(uint32_t), k, f) != (size_t)k || fread(&rec, sizeof(rec), 1, f) != 1) goto cleanup;
+        char *fields[CUBE_MAX_DEPTH];
+        int bad = 0;
+        for (int j = 0; j < k; j++)
+        {
+            if (codes[j] >= ndict[dims[j]]) bad = 1;
+            else fields[j] = dicts[dims[j]][codes[j]];
+        }
+        if (bad) goto cleanup;
+        if (w.nclauses > 0 && !where_match(&w, fields, k)) continue;
+        Group part = {NULL, rec.sum, rec.sumsq, (int)rec.count, rec.min, rec.max, (long)rec.first};
+        CubeHit *hit = &byCode[codes[xi]];
+        if (!hit->g.count || rec.first < hit->first) hit->first = rec.first;
+        group_merge(&hit->g, &part);
+    }
+    *bytes += (long long)dir[e].count * (k * sizeof(uint32_t) + sizeof(CubeRecord));
+
+    // keep the x values with rows, in the order a scan would first meet them
+    int gcount = 0;
+    for (uint32_t i = 0; i < ndict[xd]; i++)
+    {
+        if (!byCode[i].g.count) continue;
+        byCode[gcount] = byCode[i];
+        byCode[gcount].g.label = dicts[xd][i];
+        dicts[xd][i] = NULL;
+        gcount++;
+    }
+    qsort(byCode, gcount, sizeof(CubeHit), hit_order);
+    groups = malloc((gcount ? gcount : 1) * sizeof(Group));
+    if (!groups)
+    {
+        for (int i = 0; i < gcount; i++) free(byCode[i].g.label);
+        goto cleanup;
+    }
+    for (int i = 0; i < gcount; i++) groups[i] = byCode[i].g;
+    *out = groups;
+    result = gcount;
+
+cleanup:
+    free(byCode);
+    where_free(&w);
+    free(dir);
+    for (uint32_t d = 0; d < CUBE_MAX_DIMS; d++)
+    {
+        for (uint32_t i = 0; dicts[d] && i < ndict[d]; i++) free(dicts[d][i]);
+        free(dicts[d]);
+        free(names[d]);
+    }
+    free(cubeY);
+    fclose(f);
+    free(path);
+    return result;
+}
+
+// Display rollup command
+void display_rollup(char *command)
+{
+    RollupOptions opts = {0}; // null all members
+    opts.file = get_option_value(command, "file=");
+    opts.dims = get_option_value(command, "dims=");
+    opts.y = get_option_value(command, "y=");
+    opts.depth = get_option_value(command, "depth=");
+
+    if (opts.dims) mathi_string_to_lower(opts.dims);
+    if (opts.y) mathi_string_to_lower(opts.y);
+
+    char *dims[CUBE_MAX_DIMS];
+    int ndims = 0, depth = 2;
+    // Validate required
+    if (!opts.file || !opts.dims || !opts.y)
+    {
+        out_printf("Missing required options: file, dims, y\n");
+        goto cleanup;
+    }
+    if (!mathi_file_exists(opts.file))
+    {
+        out_printf("Error: file not found -> %s\n", opts.file);
+        goto cleanup;
+    }
+    if (opts.depth && (mathi_str_to_int(opts.depth, &depth) != 0 || depth < 1 || depth > CUBE_MAX_DEPTH))
+    {
+        out_printf("Error: depth must be 1 to %d\n", CUBE_MAX_DEPTH);
+        goto cleanup;
+    }
+    ndims = parse_dims(opts.dims, dims);
+    if (ndims < 0)
+    {
+        ndims = 0;
+        goto cleanup;
+    }
+
+    rollup(&opts, dims, ndims, depth < ndims ? depth : ndims);
+
+cleanup:
+    for (int i = 0; i < ndims; i++) free(dims[i]);
+    free(opts.file);
+    free(opts.dims);
+    free(opts.y);
+    free(opts.depth);
+}
@@ -0,0 +1,658 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include "../headers/mathigraphs.h"
+
+// Loaded datasets; queries hold a reference so unload never pulls one away
+// from under a running command (server workers share the registry)
+static Dataset *registry;
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Helper: free a column's bitmap index
+static void index_free(ColumnIndex *idx)
+{
+    if (!idx) return;
+    for (uint32_t i = 0; i < idx->nvalues; i++) bitmap_free(&idx->rows[i]);
+    free(idx->rows);
+    free(idx->rowOf);
+    free(idx);
+}
+
+// Helper: free a dataset and all its columns
+static void dataset_free(Dataset *ds)
+{
+    for (int c = 0; c < ds->ncols; c++)
+    {
+        index_free(ds->cols[c].index);
+        free(ds->cols[c].name);
+        free(ds->cols[c].num);
+        free(ds->cols[c].ints);
+        free(ds->cols[c].codes);
+        free(ds->cols[c].dict);
+    }
+    free(ds->cols);
+    free(ds->header);
+    free(ds->arena);
+    free(ds->name);
+    free(ds->file);
+    free(ds);
+}
+
+// Helper: append a string to the load arena, returns its offset or -1
+static long arena_add(char **arena, size_t *len, size_t *cap, const char *s)
+{
+    size_t n = strlen(s) + 1;
+    if (*len + n > *cap)
+    {
+        size_t ncap = *cap ? *cap * 2 : 1 << 16;
+        while (ncap < *len + n) ncap *= 2;
+        char *na = realloc(*arena, ncap);
+        if (!na) return -1;
+        *arena = na;
+        *cap = ncap;
+    }
+    memcpy(*arena + *len, s, n);
+    *len += n;
+    return (long)(*len - n);
+}
+
+// FNV-1a hash of a string, shared with the bar group table
+unsigned long hash_text(const char *s)
+{
+    unsigned long h = 1469598103934665603UL;
+    while (*s) h = (h ^ (unsigned char)*s++) * 1099511628211UL;
+    return h;
+}
+
+// A dataset while it is read: the text arena grows, so text values are kept
+// as offsets until the end, and each text column has its own value table
+typedef struct {
+    Dataset *ds;
+    long rcap;          // rows the column arrays have room for
+    char *arena;
+    size_t len;
+    size_t cap;
+    size_t **offs;      // per text column: arena offset of each dict value
+    uint32_t *dcap;
+    int32_t **table;    // per text column: open addressing, -1 for empty
+    size_t *tcap;
+    int *filled;        // columns with a non-empty value
+    int changed;        // the read corrected a sniffed type
+} Loader;
+
+// Helper: code of a text value in column c, added to its dictionary when
+// new; -1 when out of memory
+static long text_code(Loader *ld, int c, const char *v)
+{
+    Column *col = &ld->ds->cols[c];
+    size_t mask = ld->tcap[c] - 1;
+    size_t h = hash_text(v) & mask;
+    int32_t *table = ld->table[c];
+    while (table[h] != -1 && strcmp(ld->arena + ld->offs[c][table[h]], v) != 0) h = (h + 1) & mask;
+    if (table[h] != -1) return table[h];
+
+    if (col->ndict == ld->dcap[c])
+    {
+        size_t *no = realloc(ld->offs[c], (size_t)ld->dcap[c] * 2 * sizeof(size_t));
+        if (!no) return -1;
+        ld->offs[c] = no;
+        ld->dcap[c] *= 2;
+    }
+    long off = arena_add(&ld->arena, &ld->len, &ld->cap, v);
+    if (off < 0) return -1;
+    ld->offs[c][col->ndict] = (size_t)off;
+    table[h] = (int32_t)col->ndict;
+    long code = col->ndict++;
+
+    // keep the table at most half full
+    if ((size_t)col->ndict * 2 >= ld->tcap[c])
+    {
+        size_t ncap = ld->tcap[c] * 2;
+        int32_t *nt = malloc(ncap * sizeof(int32_t));
+        if (!nt) return -1;
+        memset(nt, 0xff, ncap * sizeof(int32_t));
+        for (uint32_t i = 0; i < col->ndict; i++)
+        {
+            size_t k = hash_text(ld->arena + ld->offs[c][i]) & (ncap - 1);
+            while (nt[k] != -1) k = (k + 1) & (ncap - 1);
+            nt[k] = (int32_t)i;
+        }
+        free(ld->table[c]);
+        ld->table[c] = nt;
+        ld->tcap[c] = ncap;
+    }
+    return code;
+}
+
+// Helper: make room for one more row in every column array
+static int loader_grow(Loader *ld)
+{
+    if (ld->ds->nrows < ld->rcap) return 0;
+    long ncap = ld->rcap * 2;
+    for (int c = 0; c < ld->ds->ncols; c++)
+    {
+        Column *col = &ld->ds->cols[c];
+        if (col->num)
+        {
+            double *n = realloc(col->num, ncap * sizeof(double));
+            if (!n) return -1;
+            col->num = n;
+        }
+        if (col->ints)
+        {
+            int32_t *n = realloc(col->ints, ncap * sizeof(int32_t));
+            if (!n) return -1;
+            col->ints = n;
+        }
+        if (col->codes)
+        {
+            uint32_t *n = realloc(col->codes, ncap * sizeof(uint32_t));
+            if (!n) return -1;
+            col->codes = n;
+        }
+    }
+    ld->rcap = ncap;
+    return 0;
+}
+
+// Helper: an integer column met a value that is not an int32: keep it as
+// doubles from here on
+static int widen_ints(Loader *ld, Column *col)
+{
+    col->num = malloc(ld->rcap * sizeof(double));
+    if (!col->num) return -1;
+    for (long r = 0; r < ld->ds->nrows; r++)
+        col->num[r] = col->ints[r] == SCHEMA_MISSING ? NAN : col->ints[r];
+    free(col->ints);
+    col->ints = NULL;
+    col->type = COLUMN_NUMBER;
+    return 0;
+}
+
+// Helper: store one cell. Returns 0, -1 when out of memory, 1 when the
+// value does not fit the column type and the column must be read as text,
+// or 2 when an integer column took a fraction and now holds doubles.
+static int store_cell(Loader *ld, int c, const char *v)
+{
+    Column *col = &ld->ds->cols[c];
+    long r = ld->ds->nrows;
+    if (*v) ld->filled[c] = 1;
+    switch (col->type)
+    {
+        case COLUMN_INT:
+        {
+            long long i;
+            if (!*v) { col->ints[r] = SCHEMA_MISSING; return 0; }
+            if (schema_int(v, &i) && i > SCHEMA_MISSING && i <= INT32_MAX) { col->ints[r] = (int32_t)i; return 0; }
+            double d;
+            if (!schema_double(v, &d)) return 1;
+            if (widen_ints(ld, col) != 0) return -1;
+            col->num[r] = d;
+            return schema_int(v, &i) ? 0 : 2; // a big integer is still one
+        }
+        case COLUMN_NUMBER:
+            if (!*v) { col->num[r] = NAN; return 0; }
+            return schema_double(v, &col->num[r]) ? 0 : 1;
+        case COLUMN_DATE:
+            if (!*v) { col->ints[r] = SCHEMA_MISSING; return 0; }
+            return schema_date(v, &col->ints[r]) ? 0 : 1;
+        default:
+        {
+            long code = text_code(ld, c, v);
+            if (code < 0) return -1;
+            col->codes[r] = (uint32_t)code;
+            return 0;
+        }
+    }
+}
+
+// Helper: free the columns and text state of a read, keeping the names
+static void loader_reset(Loader *ld)
+{
+    for (int c = 0; c < ld->ds->ncols; c++)
+    {
+        Column *col = &ld->ds->cols[c];
+        free(col->num);
+        free(col->ints);
+        free(col->codes);
+        free(col->dict);
+        col->num = NULL;
+        col->ints = NULL;
+        col->codes = NULL;
+        col->dict = NULL;
+        col->ndict = 0;
+        free(ld->offs[c]);
+        free(ld->table[c]);
+        ld->offs[c] = NULL;
+        ld->table[c] = NULL;
+        ld->filled[c] = 0;
+    }
+    free(ld->arena);
+    ld->arena = NULL;
+    ld->len = ld->cap = 0;
+    ld->rcap = 0;
+    ld->ds->nrows = 0;
+}
+
+// Helper: set up empty columns of the given types
+static int loader_start(Loader *ld, const SchemaType *types)
+{
+    ld->rcap = 4096;
+    for (int c = 0; c < ld->ds->ncols; c++)
+    {
+        Column *col = &ld->ds->cols[c];
+        switch (types[c])
+        {
+            case SCHEMA_EMPTY: // nothing seen yet: most specific, widened as needed
+            case SCHEMA_INT64: col->type = COLUMN_INT; col->ints = malloc(ld->rcap * sizeof(int32_t)); break;
+            case SCHEMA_DOUBLE: col->type = COLUMN_NUMBER; col->num = malloc(ld->rcap * sizeof(double)); break;
+            case SCHEMA_DATE: col->type = COLUMN_DATE; col->ints = malloc(ld->rcap * sizeof(int32_t)); break;
+            default:
+                col->type = COLUMN_TEXT;
+                col->codes = malloc(ld->rcap * sizeof(uint32_t));
+                ld->dcap[c] = 256;
+                ld->tcap[c] = 512;
+                ld->offs[c] = malloc(ld->dcap[c] * sizeof(size_t));
+                ld->table[c] = malloc(ld->tcap[c] * sizeof(int32_t));
+                if (!ld->offs[c] || !ld->table[c]) return -1;
+                memset(ld->table[c], 0xff, ld->tcap[c] * sizeof(int32_t)); // all -1
+        }
+        if (!col->ints && !col->num && !col->codes) return -1;
+    }
+    return 0;
+}
+
+// Helper: finish the columns: an all-empty column becomes text, text values
+// move from offsets to pointers into the arena, and memory is counted
+static int loader_finish(Loader *ld)
+{
+    Dataset *ds = ld->ds;
+    size_t cells = ds->nrows ? (size_t)ds->nrows : 1;
+    for (int c = 0; c < ds->ncols; c++)
+    {
+        Column *col = &ds->cols[c];
+        if (!ld->filled[c] && col->type != COLUMN_TEXT)
+        {
+            // all empty, as before typed columns: one text value ""
+            free(col->num);
+            free(col->ints);
+            col->num = NULL;
+            col->ints = NULL;
+            col->type = COLUMN_TEXT;
+            col->codes = calloc(cells, sizeof(uint32_t));
+            ld->offs[c] = malloc(sizeof(size_t));
+            long off = arena_add(&ld->arena, &ld->len, &ld->cap, "");
+            if (!col->codes || !ld->offs[c] || off < 0) return -1;
+            ld->offs[c][0] = (size_t)off;
+            col->ndict = 1;
+        }
+
+        // give back the room left by doubling
+        if (col->num) { double *n = realloc(col->num, cells * sizeof(double)); if (n) col->num = n; }
+        if (col->ints) { int32_t *n = realloc(col->ints, cells * sizeof(int32_t)); if (n) col->ints = n; }
+        if (col->codes) { uint32_t *n = realloc(col->codes, cells * sizeof(uint32_t)); if (n) col->codes = n; }
+
+        ds->bytes += strlen(col->name) + 1 + sizeof(Column) + sizeof(char *);
+        if (col->type == COLUMN_NUMBER) ds->bytes += cells * sizeof(double);
+        else if (col->type != COLUMN_TEXT) ds->bytes += cells * sizeof(int32_t);
+        else
+        {
+            col->dict = malloc((col->ndict ? col->ndict : 1) * sizeof(char *));
+            if (!col->dict) return -1;
+            ds->bytes += cells * sizeof(uint32_t) + col->ndict * sizeof(char *);
+        }
+    }
+
+    // the arena only holds distinct text values; fix its size and point at it
+    char *arena = realloc(ld->arena, ld->len ? ld->len : 1);
+    if (!arena) return -1;
+    ds->arena = ld->arena = arena;
+    ds->bytes += ld->len;
+    for (int c = 0; c < ds->ncols; c++)
+        for (uint32_t i = 0; ds->cols[c].type == COLUMN_TEXT && i < ds->cols[c].ndict; i++)
+            ds->cols[c].dict[i] = ds->arena + ld->offs[c][i];
+    return 0;
+}
+
+// Helper: build the bitmap index of a text, integer or date column: a value
+// number per distinct value (the dictionary code for text), and per value
+// the rows holding it, appended in row order. NULL when the column has more
+// than DATASET_INDEX_MAX_VALUES values or memory runs out; the column is
+// then filtered by a scan as before.
+static ColumnIndex *index_build(const Dataset *ds, const Column *col)
+{
+    if (col->type == COLUMN_NUMBER || (col->type == COLUMN_TEXT && col->ndict > DATASET_INDEX_MAX_VALUES)) return NULL;
+    ColumnIndex *idx = calloc(1, sizeof(ColumnIndex));
+    if (!idx) return NULL;
+    idx->rows = calloc(DATASET_INDEX_MAX_VALUES, sizeof(Bitmap));
+    idx->rowOf = malloc(DATASET_INDEX_MAX_VALUES * sizeof(long));
+    if (!idx->rows || !idx->rowOf)
+    {
+        index_free(idx);
+        return NULL;
+    }
+
+    // integer values get their numbers from a small open-addressing table
+    enum { SLOTS = DATASET_INDEX_MAX_VALUES * 2 };
+    int32_t values[DATASET_INDEX_MAX_VALUES];
+    int16_t slots[SLOTS];
+    memset(slots, 0xff, sizeof(slots)); // all -1
+    if (col->type == COLUMN_TEXT) idx->nvalues = col->ndict;
+
+    for (long r = 0; r < ds->nrows; r++)
+    {
+        uint32_t id;
+        if (col->type == COLUMN_TEXT) id = col->codes[r];
+        else
+        {
+            int32_t v = col->ints[r];
+            size_t h = ((uint32_t)v * 2654435761u) & (SLOTS - 1);
+            while (slots[h] != -1 && values[slots[h]] != v) h = (h + 1) & (SLOTS - 1);
+            if (slots[h] == -1)
+            {
+                if (idx->nvalues == DATASET_INDEX_MAX_VALUES)
+                {
+                    index_free(idx);
+                    return NULL;
+                }
+                values[idx->nvalues] = v;
+                slots[h] = (int16_t)idx->nvalues++;
+            }
+            id = slots[h];
+        }
+        if (idx->rows[id].nchunks == 0) idx->rowOf[id] = r;
+        if (bitmap_append(&idx->rows[id], (uint32_t)r) != 0)
+        {
+            index_free(idx);
+            return NULL;
+        }
+    }
+    for (uint32_t i = 0; i < idx->nvalues; i++) bitmap_trim(&idx->rows[i]);
+    return idx;
+}
+
+// Helper: index every column with few enough distinct values, counting the
+// memory the bitmaps take
+static void dataset_index(Dataset *ds)
+{
+    if (ds->nrows == 0 || ds->nrows > (long)UINT32_MAX) return; // row ids are 32-bit
+    for (int c = 0; c < ds->ncols; c++)
+    {
+        ColumnIndex *idx = ds->cols[c].index = index_build(ds, &ds->cols[c]);
+        if (!idx) continue;
+        ds->bytes += sizeof(ColumnIndex) + DATASET_INDEX_MAX_VALUES * (sizeof(Bitmap) + sizeof(long));
+        for (uint32_t i = 0; i < idx->nvalues; i++) ds->bytes += bitmap_bytes(&idx->rows[i]);
+    }
+}
+
+// Helper: read every row into columns of the given types. Returns 0, -1 on
+// failure (out of memory or cancelled), or 1 when a value did not fit its
+// column: that column's type is then set to text for another read.
+static int loader_read(Loader *ld, CsvReader *csv, SchemaType *types)
+{
+    if (loader_start(ld, types) != 0) return -1;
+    int nf;
+    while ((nf = csv_next(csv)) >= 0)
+    {
+        if (loader_grow(ld) != 0) return -1;
+        for (int c = 0; c < ld->ds->ncols; c++)
+        {
+            int rc = store_cell(ld, c, c < nf ? csv->fields[c] : "");
+            if (rc < 0) return -1;
+            if (rc == 2)
+            {
+                types[c] = SCHEMA_DOUBLE;
+                ld->changed = 1;
+            }
+            else if (rc == 1)
+            {
+                types[c] = SCHEMA_TEXT;
+                ld->changed = 1;
+                return 1;
+            }
+        }
+        ld->ds->nrows++;
+    }
+    return cancel_requested() ? -1 : 0;
+}
+
+// Helper: parse a whole CSV file into a dataset, NULL (with a message) on
+// failure. Each column is parsed straight into its typed array, with the
+// types sniffed from the first rows (see schema_get). If a later value does
+// not fit, its column is made text, the file read again and the schema cache
+// corrected, so the result never depends on the sample.
+static Dataset *dataset_read(const char *name, const char *file)
+{
+    CsvReader csv;
+    int rc = csv_open(&csv, file);
+    if (rc != 0)
+    {
+        csv_open_error(rc, file);
+        return NULL;
+    }
+
+    Loader ld = {0};
+    SchemaType *types = malloc(csv.ncols * sizeof(SchemaType));
+    Dataset *ds = ld.ds = calloc(1, sizeof(Dataset));
+    ld.offs = calloc(csv.ncols, sizeof(size_t *));
+    ld.dcap = calloc(csv.ncols, sizeof(uint32_t));
+    ld.table = calloc(csv.ncols, sizeof(int32_t *));
+    ld.tcap = calloc(csv.ncols, sizeof(size_t));
+    ld.filled = calloc(csv.ncols, sizeof(int));
+    if (!types || !ds || !ld.offs || !ld.dcap || !ld.table || !ld.tcap || !ld.filled) goto oom;
+
+    ds->name = strdup(name);
+    ds->file = strdup(file);
+    ds->cols = calloc(csv.ncols, sizeof(Column));
+    ds->header = calloc(csv.ncols, sizeof(char *));
+    if (!ds->name || !ds->file || !ds->cols || !ds->header) goto oom;
+    ds->ncols = csv.ncols;
+    for (int c = 0; c < ds->ncols; c++)
+    {
+        ds->cols[c].name = strdup(csv.header[c]);
+        if (!ds->cols[c].name) goto oom;
+        ds->header[c] = ds->cols[c].name;
+    }
+
+    if (schema_get(file, types, ds->ncols) != 0)
+        for (int c = 0; c < ds->ncols; c++) types[c] = SCHEMA_TEXT;
+    while ((rc = loader_read(&ld, &csv, types)) == 1)
+    {
+        loader_reset(&ld);
+        if (csv_rewind(&csv) != 0) goto oom;
+    }
+    if (rc != 0)
+    {
+        if (cancel_requested()) goto fail; // Ctrl-C: drop the partial load
+        goto oom;
+    }
+    if (ld.changed) schema_update(file, types, ds->ncols);
+    if (loader_finish(&ld) != 0) goto oom;
+    ld.arena = NULL; // now the dataset's
+    dataset_index(ds);
+
+    csv_close(&csv);
+    for (int c = 0; c < ds->ncols; c++)
+    {
+        free(ld.offs[c]);
+        free(ld.table[c]);
+    }
+    free(ld.offs); free(ld.dcap); free(ld.table); free(ld.tcap); free(ld.filled);
+    free(types);
+    return ds;
+
+oom:
+    out_printf("Error: out of memory\n");
+fail:
+    csv_close(&csv);
+    if (ds && ds->cols && ld.offs && ld.table && ld.filled) loader_reset(&ld);
+    if (ds) dataset_free(ds);
+    free(ld.offs); free(ld.dcap); free(ld.table); free(ld.tcap); free(ld.filled);
+    free(types);
+    return NULL;
+}
+
+// Helper: take a dataset out of the registry, lock held. Returns it or NULL.
+static Dataset *registry_unlink(const char *name)
+{
+    for (Dataset **p = &registry; *p; p = &(*p)->next)
+    {
+        if (strcmp((*p)->name, name) == 0)
+        {
+            Dataset *ds = *p;
+            *p = ds->next;
+            ds->next = NULL;
+            return ds;
+        }
+    }
+    return NULL;
+}
+
+// Find a loaded dataset and hold it for a query; NULL if not loaded
+Dataset *dataset_acquire(const char *name)
+{
+    pthread_mutex_lock(&registry_lock);
+    Dataset *ds = registry;
+    while (ds && strcmp(ds->name, name) != 0) ds = ds->next;
+    if (ds) ds->refs++;
+    pthread_mutex_unlock(&registry_lock);
+    return ds;
+}
+
+// Drop a reference; the last one frees an unloaded dataset
+void dataset_release(Dataset *ds)
+{
+    if (!ds) return;
+    pthread_mutex_lock(&registry_lock);
+    int last = --ds->refs == 0;
+    pthread_mutex_unlock(&registry_lock);
+    if (last) dataset_free(ds);
+}
+
+// Find a column index by (lowercase) name, -1 if missing
+int dataset_find_column(const Dataset *ds, const char *name)
+{
+    for (int c = 0; c < ds->ncols; c++)
+        if (strcmp(ds->cols[c].name, name) == 0) return c;
+    return -1;
+}
+
+// A cell as text; numbers and dates are formatted into buf
+const char *dataset_text(const Dataset *ds, int col, long row, char *buf, size_t size)
+{
+    const Column *c = &ds->cols[col];
+    if (c->type == COLUMN_TEXT) return c->dict[c->codes[row]];
+    if (c->type != COLUMN_NUMBER)
+    {
+        if (c->ints[row] == SCHEMA_MISSING) return "";
+        if (c->type == COLUMN_DATE) ts_format(c->ints[row] * 86400LL, 86400, buf, size);
+        else snprintf(buf, size, "%d", c->ints[row]);
+        return buf;
+    }
+    if (isnan(c->num[row])) return "";
+    snprintf(buf, size, "%.15g", c->num[row]);
+    return buf;
+}
+
+// A cell as a number, 0 if it is empty or not a number (dates are not)
+int dataset_number(const Dataset *ds, int col, long row, double *out)
+{
+    const Column *c = &ds->cols[col];
+    switch (c->type)
+    {
+        case COLUMN_TEXT: return csv_number(c->dict[c->codes[row]], out);
+        case COLUMN_DATE: return 0;
+        case COLUMN_INT:
+            *out = c->ints[row];
+            return c->ints[row] != SCHEMA_MISSING;
+        default:
+            *out = c->num[row];
+            return !isnan(*out);
+    }
+}
+
+// Display load command: parse a CSV once into typed in-memory columns
+void display_load(char *command)
+{
+    LoadOptions opts = {0}; // null all members
+    opts.name = get_option_value(command, "name=");
+    opts.file = get_option_value(command, "file=");
+
+    // Validate required
+    if (!opts.name || !opts.file)
+    {
+        out_printf("Missing required options: name, file\n");
+        goto cleanup;
+    }
+
+    if (!mathi_file_exists(opts.file))
+    {
+        out_printf("Error: file not found -> %s\n", opts.file);
+        goto cleanup;
+    }
+
+    Dataset *ds = dataset_read(opts.name, opts.file);
+    if (!ds) goto cleanup;
+
+    // loading again under the same name replaces the old copy
+    pthread_mutex_lock(&registry_lock);
+    Dataset *old = registry_unlink(opts.name);
+    ds->refs = 1;
+    ds->next = registry;
+    registry = ds;
+    pthread_mutex_unlock(&registry_lock);
+    dataset_release(old);
+
+    int kinds[4] = {0}, indexed = 0;
+    for (int c = 0; c < ds->ncols; c++)
+    {
+        kinds[ds->cols[c].type]++;
+        indexed += ds->cols[c].index != NULL;
+    }
+    out_printf("Loaded '%s': %ld rows, %d columns (%d int, %d double, %d date, %d text), %d indexed, %.1f MB\n",
+               ds->name, ds->nrows, ds->ncols, kinds[COLUMN_INT], kinds[COLUMN_NUMBER], kinds[COLUMN_DATE],
+               kinds[COLUMN_TEXT], indexed, ds->bytes / (1024.0 * 1024.0));
+
+cleanup:
+    free(opts.name);
+    free(opts.file);
+}
+
+// Display unload command
+void display_unload(char *command)
+{
+    char *name = get_option_value(command, "name=");
+    if (!name)
+    {
+        out_printf("Missing required options: name\n");
+        return;
+    }
+
+    pthread_mutex_lock(&registry_lock);
+    Dataset *ds = registry_unlink(name);
+    pthread_mutex_unlock(&registry_lock);
+
+    if (ds) out_printf("Unloaded '%s'\n", name);
+    else out_printf("Error: dataset not loaded -> %s\n", name);
+    dataset_release(ds);
+    free(name);
+}
+
+// Display datasets command: every loaded dataset with its memory use
+void display_datasets(void)
+{
+    pthread_mutex_lock(&registry_lock);
+    if (!registry) out_printf("No datasets loaded.\n");
+    else out_printf("%-16s %12s %8s %14s  %s\n", "name", "rows", "columns", "bytes", "file");
+
+    size_t total = 0;
+    for (Dataset *ds = registry; ds; ds = ds->next)
+    {
+        out_printf("%-16s %12ld %8d %14zu  %s\n", ds->name, ds->nrows, ds->ncols, ds->bytes, ds->file);
+        total += ds->bytes;
+    }
+    if (registry) out_printf("%-16s %12s %8s %14zu\n", "total", "", "", total);
+    pthread_mutex_unlock(&registry_lock);
+}
@@ -0,0 +1,470 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "../headers/mathigraphs.h"
+
+// Rough malloc overhead per label, so the estimate tracks real heap use
+#define LABEL_OVERHEAD 16
+
+// Fixed part of a spill record; the label bytes follow it
+typedef struct {
+    double sum;
+    double sumsq;
+    double min;
+    double max;
+    int64_t first;
+    int32_t count;
+    uint32_t len;
+} SpillRecord;
+
+// Fold one value into a group
+void group_add(Group *g, double val)
+{
+    if (g->count == 0) { g->min = val; g->max = val; }
+    g->sum += val;
+    g->sumsq += val * val;
+    g->count++;
+    if (val < g->min) g->min = val;
+    if (val > g->max) g->max = val;
+}
+
+// Fold a partial aggregate of the same label into a group
+void group_merge(Group *g, const Group *part)
+{
+    if (g->count == 0) { g->min = part->min; g->max = part->max; g->first = part->first; }
+    if (part->first < g->first) g->first = part->first;
+    g->sum += part->sum;
+    g->sumsq += part->sumsq;
+    g->count += part->count;
+    if (part->min < g->min) g->min = part->min;
+    if (part->max > g->max) g->max = part->max;
+}
+
+// Free groups and their labels
+void groups_free(Group *groups, int gcount)
+{
+    for (int i = 0; i < gcount; i++) free(groups[i].label);
+    free(groups);
+}
+
+// Helper: heap bytes of the table's arrays
+static long long table_bytes(const GroupTable *t)
+{
+    return (long long)t->gcap * sizeof(Group) + (long long)t->tcap * sizeof(int);
+}
+
+// Helper: a new empty group at the end of the array, not yet indexed
+static Group *append_group(GroupTable *t, const char *label)
+{
+    if (t->gcount == t->gcap)
+    {
+        int ncap = t->gcap ? t->gcap * 2 : 64;
+        Group *ng = realloc(t->groups, ncap * sizeof(Group));
+        if (!ng) return NULL;
+        t->bytes -= table_bytes(t);
+        t->groups = ng;
+        t->gcap = ncap;
+        t->bytes += table_bytes(t);
+    }
+    Group *g = &t->groups[t->gcount];
+    memset(g, 0, sizeof(Group));
+    g->label = strdup(label);
+    if (!g->label) return NULL;
+    t->bytes += strlen(label) + 1 + LABEL_OVERHEAD;
+    t->gcount++;
+    return g;
+}
+
+// The group for a label, added empty when it is new. NULL when out of memory.
+Group *group_table_get(GroupTable *t, const char *label)
+{
+    // keep the table at most half full; groups added by group_table_append
+    // are indexed here too
+    if ((size_t)t->gcount * 2 >= t->tcap)
+    {
+        size_t ncap = t->tcap ? t->tcap * 2 : 1024;
+        while ((size_t)t->gcount * 2 >= ncap) ncap *= 2;
+        int *nt = malloc(ncap * sizeof(int));
+        if (!nt) return NULL;
+        memset(nt, 0xff, ncap * sizeof(int)); // all -1
+        for (int i = 0; i < t->gcount; i++)
+        {
+            size_t h = hash_text(t->groups[i].label) & (ncap - 1);
+            while (nt[h] != -1) h = (h + 1) & (ncap - 1);
+            nt[h] = i;
+        }
+        t->bytes -= table_bytes(t);
+        free(t->table);
+        t->table = nt;
+        t->tcap = ncap;
+        t->bytes += table_bytes(t);
+    }
+
+    size_t h = hash_text(label) & (t->tcap - 1);
+    while (t->table[h] != -1 && strcmp(t->groups[t->table[h]].label, label) != 0) h = (h + 1) & (t->tcap - 1);
+    if (t->table[h] != -1) return &t->groups[t->table[h]];
+
+    Group *g = append_group(t, label);
+    if (!g) return NULL;
+    t->table[h] = t->gcount - 1;
+    return g;
+}
+
+// Add a group for a label the caller knows is new, without hashing it. Any
+// index is dropped; the next group_table_get rebuilds it over all groups.
+Group *group_table_append(GroupTable *t, const char *label)
+{
+    if (t->table)
+    {
+        t->bytes -= table_bytes(t);
+        free(t->table);
+        t->table = NULL;
+        t->tcap = 0;
+        t->bytes += table_bytes(t);
+    }
+    return append_group(t, label);
+}
+
+// Release the table, its groups and their labels
+void group_table_free(GroupTable *t)
+{
+    groups_free(t->groups, t->gcount);
+    free(t->table);
+    memset(t, 0, sizeof(*t));
+}
+
+// Parse a memory size such as '512k', '64m', '2g' or plain bytes. Returns 1 on success.
+int group_limit(const char *spec, long long *bytes)
+{
+    char *end;
+    double n = strtod(spec, &end);
+    if (end == spec || n <= 0) return 0;
+
+    double unit = 1;
+    if (strcmp(end, "k") == 0 || strcmp(end, "kb") == 0) unit = 1024.0;
+    else if (strcmp(end, "m") == 0 || strcmp(end, "mb") == 0) unit = 1024.0 * 1024;
+    else if (strcmp(end, "g") == 0 || strcmp(end, "gb") == 0) unit = 1024.0 * 1024 * 1024;
+    else if (*end != '\0' && strcmp(end, "b") != 0) return 0;
+
+    *bytes = (long long)(n * unit);
+    return *bytes > 0;
+}
+
+// Create the partition files of one spill level. They are unlinked temporary
+// files, so nothing is left behind when the query ends or the process dies.
+int spill_open(Spill *s, int depth)
+{
+    memset(s, 0, sizeof(*s));
+    s->depth = depth;
+    for (int i = 0; i < SPILL_PARTITIONS; i++)
+    {
+        s->part[i] = tmpfile();
+        if (!s->part[i])
+        {
+            out_printf("Error: could not create a spill file\n");
+            spill_close(s);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Append a partial group to the partition its label hashes to. The
+// partition takes bits the group table does not use, so keys that share a
+// partition still spread over its table.
+int spill_write(Spill *s, const char *label, const Group *g)
+{
+    unsigned long h = hash_text(label);
+    FILE *f = s->part[(h >> (60 - 4 * s->depth)) & (SPILL_PARTITIONS - 1)];
+
+    SpillRecord rec = {g->sum, g->sumsq, g->min, g->max, g->first, g->count, (uint32_t)strlen(label)};
+    if (fwrite(&rec, sizeof(rec), 1, f) != 1 || fwrite(label, 1, rec.len, f) != rec.len)
+    {
+        out_printf("Error: could not write spill file (disk full?)\n");
+        return -1;
+    }
+    s->bytes += sizeof(rec) + rec.len;
+    return 0;
+}
+
+// Move every group of a table into the partitions and empty the table
+int spill_table(Spill *s, GroupTable *t)
+{
+    int rc = 0;
+    for (int i = 0; rc == 0 && i < t->gcount; i++) rc = spill_write(s, t->groups[i].label, &t->groups[i]);
+    group_table_free(t);
+    return rc;
+}
+
+// Helper: read one record, 1 when read, 0 at the end, -1 on a short read
+static int spill_read(FILE *f, char **label, size_t *cap, Group *g)
+{
+    SpillRecord rec;
+    size_t n = fread(&rec, sizeof(rec), 1, f);
+    if (n != 1) return feof(f) ? 0 : -1;
+    if (rec.len + 1 > *cap)
+    {
+        size_t ncap = rec.len + 1 > 256 ? rec.len + 1 : 256;
+        char *nl = realloc(*label, ncap);
+        if (!nl) return -1;
+        *label = nl;
+        *cap = ncap;
+    }
+    if (fread(*label, 1, rec.len, f) != rec.len) return -1;
+    (*label)[rec.len] = '\0';
+    g->sum = rec.sum;
+    g->sumsq = rec.sumsq;
+    g->min = rec.min;
+    g->max = rec.max;
+    g->first = (long)rec.first;
+    g->count = rec.count;
+    return 1;
+}
+
+// Helper: aggregate the partitions of one level and hand each finished
+// partition to sink. A partition whose table outgrows the limit is split
+// again on the next hash bits; past SPILL_MAX_DEPTH it is finished in memory
+// over the limit.
+static int merge_level(Spill *s, long long limit, GroupSink sink, void *ctx)
+{
+    char *label = NULL;
+    size_t labelCap = 0;
+    int rc = 0;
+    for (int p = 0; rc == 0 && p < SPILL_PARTITIONS; p++)
+    {
+        FILE *f = s->part[p];
+        if (cancel_requested() || fflush(f) != 0 || fseek(f, 0, SEEK_SET) != 0) { rc = -1; break; }
+
+        GroupTable t = {0};
+        Spill child;
+        int split = 0;
+        Group part;
+        int got;
+        while ((got = spill_read(f, &label, &labelCap, &part)) == 1)
+        {
+            if (split)
+            {
+                if ((rc = spill_write(&child, label, &part)) != 0) break;
+                continue;
+            }
+            Group *g = group_table_get(&t, label);
+            if (!g) { out_printf("Error: out of memory\n"); rc = -1; break; }
+            group_merge(g, &part);
+            if (t.bytes > limit && s->depth + 1 < SPILL_MAX_DEPTH)
+            {
+                if ((rc = spill_open(&child, s->depth + 1)) != 0) break;
+                split = 1;
+                if ((rc = spill_table(&child, &t)) != 0) break;
+            }
+        }
+        if (rc == 0 && got < 0) { out_printf("Error: could not read spill file\n"); rc = -1; }
+
+        // the partition is done; its file space goes back before the next one
+        if (ftruncate(fileno(f), 0) != 0) rc = -1;
+        if (rc == 0 && split)
+        {
+            rc = merge_level(&child, limit, sink, ctx);
+            s->bytes += child.bytes;
+        }
+        else if (rc == 0 && t.gcount > 0) rc = sink(t.groups, t.gcount, ctx);
+        if (split) spill_close(&child);
+        group_table_free(&t);
+    }
+    free(label);
+    return rc;
+}
+
+// Aggregate everything written to the partitions. Each partition's groups
+// go to sink as soon as they are complete, so only one partition is in
+// memory at a time; the sink must copy what it keeps. Returns 0, or -1 after
+// a failure (with a message) or a cancel.
+int spill_aggregate(Spill *s, long long limit, GroupSink sink, void *ctx)
+{
+    return merge_level(s, limit, sink, ctx);
+}
+
+// Close and so delete the partition files
+void spill_close(Spill *s)
+{
+    for (int i = 0; i < SPILL_PARTITIONS; i++)
+    {
+        if (s->part[i]) fclose(s->part[i]);
+        s->part[i] = NULL;
+    }
+}
+
+// Helper: order of two results in a run; ties keep first-seen order, as
+// finish_bar's sort does
+static int result_compare(const GroupResult *a, const GroupResult *b, RunsOrder order)
+{
+    int cmp = 0;
+    if (order == RUNS_BY_VALUE) cmp = a->value < b->value ? 1 : a->value > b->value ? -1 : 0;
+    else if (order == RUNS_BY_LABEL) cmp = strcmp(a->label, b->label);
+    if (cmp) return cmp;
+    return a->first < b->first ? -1 : a->first > b->first;
+}
+
+static _Thread_local RunsOrder sort_order; // qsort has no context argument
+
+// Helper: qsort adapter for result_compare
+static int result_qsort(const void *a, const void *b)
+{
+    return result_compare(a, b, sort_order);
+}
+
+// Start an empty set of result runs in one temporary file
+int runs_open(GroupRuns *r, RunsOrder order)
+{
+    memset(r, 0, sizeof(*r));
+    r->order = order;
+    r->file = tmpfile();
+    if (!r->file)
+    {
+        out_printf("Error: could not create a spill file\n");
+        return -1;
+    }
+    return 0;
+}
+
+// Append results as one run, sorted by the runs' order
+int runs_add(GroupRuns *r, GroupResult *items, int n)
+{
+    if (r->nruns == r->runcap)
+    {
+        int ncap = r->runcap ? r->runcap * 2 : 16;
+        long *ns = realloc(r->starts, ncap * sizeof(long));
+        if (!ns) { out_printf("Error: out of memory\n"); return -1; }
+        r->starts = ns;
+        r->runcap = ncap;
+    }
+    r->starts[r->nruns++] = ftell(r->file);
+
+    sort_order = r->order;
+    qsort(items, n, sizeof(GroupResult), result_qsort);
+    for (int i = 0; i < n; i++)
+    {
+        uint32_t len = (uint32_t)strlen(items[i].label);
+        int64_t first = items[i].first;
+        if (fwrite(&items[i].value, sizeof(double), 1, r->file) != 1 || fwrite(&first, sizeof(first), 1, r->file) != 1 ||
+            fwrite(&len, sizeof(len), 1, r->file) != 1 || fwrite(items[i].label, 1, len, r->file) != len)
+        {
+            out_printf("Error: could not write spill file (disk full?)\n");
+            return -1;
+        }
+        if (r->count == 0 || items[i].value > r->maxValue) r->maxValue = items[i].value;
+        if ((int)len > r->maxLabel) r->maxLabel = (int)len;
+        r->count++;
+        r->bytes += sizeof(double) + sizeof(first) + sizeof(len) + len;
+    }
+    return 0;
+}
+
+// Read position in one run, with its own small buffer
+typedef struct {
+    long pos;           // next file offset to buffer
+    long end;           // where the run ends
+    char buf[4096];
+    size_t len;
+    size_t off;
+    GroupResult head;   // current result, label in labelBuf
+    char *labelBuf;
+    size_t labelCap;
+    int done;
+} RunCursor;
+
+// Helper: copy n bytes of the run into dst, refilling the buffer with pread
+static int cursor_bytes(int fd, RunCursor *c, void *dst, size_t n)
+{
+    char *out = dst;
+    while (n > 0)
+    {
+        if (c->off == c->len)
+        {
+            size_t want = c->end - c->pos < (long)sizeof(c->buf) ? (size_t)(c->end - c->pos) : sizeof(c->buf);
+            ssize_t got = want ? pread(fd, c->buf, want, c->pos) : 0;
+            if (got <= 0) return -1;
+            c->pos += got;
+            c->len = (size_t)got;
+            c->off = 0;
+        }
+        size_t take = c->len - c->off < n ? c->len - c->off : n;
+        memcpy(out, c->buf + c->off, take);
+        c->off += take;
+        out += take;
+        n -= take;
+    }
+    return 0;
+}
+
+// Helper: load the next result of a run into c->head, marking the end
+static int cursor_next(int fd, RunCursor *c)
+{
+    if (c->pos == c->end && c->off == c->len) { c->done = 1; return 0; }
+    uint32_t len;
+    int64_t first;
+    if (cursor_bytes(fd, c, &c->head.value, sizeof(double)) != 0 || cursor_bytes(fd, c, &first, sizeof(first)) != 0 ||
+        cursor_bytes(fd, c, &len, sizeof(len)) != 0) return -1;
+    c->head.first = (long)first;
+    if (len + 1 > c->labelCap)
+    {
+        char *nl = realloc(c->labelBuf, len + 1);
+        if (!nl) return -1;
+        c->labelBuf = nl;
+        c->labelCap = len + 1;
+    }
+    if (cursor_bytes(fd, c, c->labelBuf, len) != 0) return -1;
+    c->labelBuf[len] = '\0';
+    c->head.label = c->labelBuf;
+    return 0;
+}
+
+// Call emit for every result, the runs merged so the whole sequence is in
+// their order. Memory is one buffer per run.
+int runs_each(GroupRuns *r, int (*emit)(const GroupResult *item, void *ctx), void *ctx)
+{
+    if (fflush(r->file) != 0) return -1;
+    long end = ftell(r->file);
+    int fd = fileno(r->file);
+
+    int k = r->nruns;
+    RunCursor *cur = calloc(k ? k : 1, sizeof(RunCursor));
+    if (!cur) { out_printf("Error: out of memory\n"); return -1; }
+
+    int rc = 0;
+    for (int i = 0; rc == 0 && i < k; i++)
+    {
+        cur[i].pos = r->starts[i];
+        cur[i].end = i == k - 1 ? end : r->starts[i + 1];
+        rc = cursor_next(fd, &cur[i]);
+    }
+
+    long emitted = 0;
+    while (rc == 0)
+    {
+        int best = -1;
+        for (int i = 0; i < k; i++)
+        {
+            if (cur[i].done) continue;
+            if (best == -1 || result_compare(&cur[i].head, &cur[best].head, r->order) < 0) best = i;
+        }
+        if (best == -1) break;
+        if (emitted++ % CANCEL_CHECK_ROWS == 0 && cancel_requested()) { rc = -1; break; }
+        rc = emit(&cur[best].head, ctx);
+        if (rc == 0) rc = cursor_next(fd, &cur[best]);
+    }
+    if (rc != 0 && !cancel_requested()) out_printf("Error: could not read spill file\n");
+
+    for (int i = 0; i < k; i++) free(cur[i].labelBuf);
+    free(cur);
+    return rc;
+}
+
+// Close and so delete the runs file
+void runs_close(GroupRuns *r)
+{
+    if (r->file) fclose(r->file);
+    free(r->starts);
+    memset(r, 0, sizeof(*r));
+}
@@ -2,34 +2,252 @@
 
 void bar_help() 
 {
-    printf("\n=== Mathi Graphs: Bar Command Help ===\n\n");
-
-    printf("Usage:\n");
-    printf("  bar [options]\n\n");
-    printf("Description:\n");
-    printf("  Generate a bar graph from a CSV file with optional aggregation.\n\n");
-
-    printf("Required options:\n");
-    printf("  file='path/to/file.csv'   Specify the CSV file path\n");
-    printf("  x='column_name'           Column to use for X-axis labels\n");
-    printf("  y='column_name'           Column to use for Y-axis values\n\n");
-
-    printf("Optional options:\n");
-    printf("  title='Graph Title'       Title for the bar graph\n");
-    printf("  compute='method'          Aggregation method for Y values per X label\n");
-    printf("                            Available methods: avg (default), sum, max, min\n\n");
-
-    printf("Behavior:\n");
-    printf("  - If 'compute' is not specified, the average (avg) will be used.\n");
-    printf("  - The bar length is scaled to fit the console width.\n");
-    printf("  - Non-numeric Y values or missing labels will be skipped with a warning.\n\n");
-
-    printf("Example:\n");
-    printf("  bar file='assets/company.csv' x='Year' y='Salary' title='Average Salary per Year'\n");
-    printf("  bar file='assets/company.csv' x='Year' y='Salary' compute='sum' title='Total Salaries per Year'\n\n");
-
-    printf("Notes:\n");
-    printf("  - Column names are case-insensitive.\n");
-    printf("  - Ensure the CSV file exists and has a proper header row.\n");
-    printf("  - Invalid 'compute' methods will be rejected with an error message.\n\n");
-}
\ No newline at end of file
+    out_printf("\n=== Mathi Graphs: Bar Command Help ===\n\n");
+
+    out_printf("Usage:\n");
+    out_printf("  bar [options]\n\n");
+    out_printf("Description:\n");
+    out_printf("  Generate a bar graph from a CSV file with optional aggregation.\n\n");
+
+    out_printf("Required options:\n");
+    out_printf("  file='path/to/file.csv'   Specify the CSV file path\n");
+    out_printf("  x='column_name'           Column to use for X-axis labels\n");
+    out_printf("  y='column_name'           Column to use for Y-axis values\n\n");
+
+    out_printf("Optional options:\n");
+    out_printf("  data='name'               Query a dataset loaded with load, instead of file\n");
+    out_printf("  title='Graph Title'       Title for the bar graph\n");
+    out_printf("  compute='method'          Aggregation method for Y values per X label\n");
+    out_printf("                            Available methods: avg (default), sum, max, min\n");
+    out_printf("  bucket='1h'               Treat X as a time (ISO-8601 or epoch) and group by\n");
+    out_printf("                            time bucket: Ns, Nm, Nh, Nd or Nw (e.g. 15m, 1d)\n");
+    out_printf("  profile='1'               Print wall/CPU nanoseconds, rows and bytes per stage\n");
+    out_printf("                            (open, header, parse, aggregate, sort, render)\n");
+    out_printf("  format='json'             Print results and query statistics as one JSON line\n");
+    out_printf("                            instead of the chart\n");
+    out_printf("  where='year >= 2022 and department = hr'\n");
+    out_printf("                            Keep only matching rows; = != < <= > >=, joined by\n");
+    out_printf("                            and/or (and binds tighter). Text compares ignore case\n");
+    out_printf("  mem_limit='64m'           Cap the group table (k, m or g); past it, groups are\n");
+    out_printf("                            hash-partitioned into temporary files on disk\n");
+    out_printf("  presorted='1'             X is sorted: warn if it is not. '0' skips the check\n");
+    out_printf("                            (sorted X is detected and grouped without hashing)\n");
+    out_printf("  sample='0.01'             Estimate from about this share of the rows, with a\n");
+    out_printf("                            95%% confidence interval per bar (avg and sum)\n");
+    out_printf("  sample_rows='10000'       Estimate from this many rows, drawn uniformly\n");
+    out_printf("  progress='0'              Turn off the partial charts long scans redraw on a\n");
+    out_printf("                            terminal; '1' shows them even when output is piped\n");
+    out_printf("  join='centers.csv' on='emp_id'\n");
+    out_printf("                            Add the columns of another file to each row whose\n");
+    out_printf("                            on= key it shares (x, y and where may use them)\n");
+    out_printf("  window='7d'               Rolling compute over the groups in X order: the\n");
+    out_printf("                            last N groups (window=7), or a time span of X\n");
+    out_printf("  cube='0'                  Scan the file even when a rollup cube could answer\n\n");
+
+    out_printf("Behavior:\n");
+    out_printf("  - If 'compute' is not specified, the average (avg) will be used.\n");
+    out_printf("  - The bar length is scaled to fit the console width.\n");
+    out_printf("  - Non-numeric Y values or missing labels will be skipped with a warning.\n\n");
+
+    out_printf("Example:\n");
+    out_printf("  bar file='assets/company.csv' x='Year' y='Salary' title='Average Salary per Year'\n");
+    out_printf("  bar file='assets/company.csv' x='Year' y='Salary' compute='sum' title='Total Salaries per Year'\n\n");
+
+    out_printf("Notes:\n");
+    out_printf("  - Column names are case-insensitive.\n");
+    out_printf("  - Ensure the CSV file exists and has a proper header row.\n");
+    out_printf("  - Invalid 'compute' methods will be rejected with an error message.\n\n");
+}
+void hist_help()
+{
+    out_printf("\n=== Mathi Graphs: Hist Command Help ===\n\n");
+
+    out_printf("Usage:\n");
+    out_printf("  hist [options]\n\n");
+    out_printf("Description:\n");
+    out_printf("  Count the values of a numeric column into equal-width bins.\n\n");
+
+    out_printf("Required options:\n");
+    out_printf("  file='path/to/file.csv'   Specify the CSV file path\n");
+    out_printf("  col='column_name'         Numeric column to bin\n\n");
+
+    out_printf("Optional options:\n");
+    out_printf("  bins=N                    Number of bins (default 10, max 1000)\n");
+    out_printf("  min=N max=N               Fixed range; values outside it are skipped\n");
+    out_printf("  title='Graph Title'       Title for the histogram\n\n");
+
+    out_printf("Behavior:\n");
+    out_printf("  - Without both min and max, a first pass over the column finds the range.\n");
+    out_printf("  - Only the bin counters are kept in memory, never the values.\n\n");
+
+    out_printf("Example:\n");
+    out_printf("  hist file='assets/company.csv' col='salary' bins=8 title='Salary Distribution'\n\n");
+}
+
+void line_help()
+{
+    out_printf("\n=== Mathi Graphs: Line Command Help ===\n\n");
+
+    out_printf("Usage:\n");
+    out_printf("  line [options]\n\n");
+    out_printf("Description:\n");
+    out_printf("  Draw a line chart of Y against a numeric X column.\n\n");
+
+    out_printf("Required options:\n");
+    out_printf("  file='path/to/file.csv'   Specify the CSV file path\n");
+    out_printf("  x='column_name'           Numeric or time (ISO-8601/epoch) column for the X-axis\n");
+    out_printf("  y='column_name'           Numeric column for the Y-axis\n\n");
+
+    out_printf("Optional options:\n");
+    out_printf("  title='Graph Title'       Title for the line chart\n");
+    out_printf("  width=N height=N          Plot size in characters (default: terminal width, 20 rows)\n");
+    out_printf("  window='1h'               Plot a rolling value: the last N points (window=60)\n");
+    out_printf("                            or the points within a span of X (s, m, h, d, w)\n");
+    out_printf("  compute='method'          Rolling method: avg (default), sum, max, min\n\n");
+
+    out_printf("Behavior:\n");
+    out_printf("  - Points are downsampled to about two per column with Largest-Triangle-Three-Buckets.\n");
+    out_printf("  - Memory depends on the plot width only, not on the number of rows.\n");
+    out_printf("  - Rows with a non-numeric X or Y are skipped.\n\n");
+
+    out_printf("Example:\n");
+    out_printf("  line file='metrics.csv' x='ts' y='latency' title='Latency'\n\n");
+}
+
+void scatter_help()
+{
+    out_printf("\n=== Mathi Graphs: Scatter Command Help ===\n\n");
+
+    out_printf("Usage:\n");
+    out_printf("  scatter [options]\n\n");
+    out_printf("Description:\n");
+    out_printf("  Plot the density of (X, Y) pairs from two numeric columns.\n\n");
+
+    out_printf("Required options:\n");
+    out_printf("  file='path/to/file.csv'   Specify the CSV file path\n");
+    out_printf("  x='column_name'           Numeric column for the X-axis\n");
+    out_printf("  y='column_name'           Numeric column for the Y-axis\n\n");
+
+    out_printf("Optional options:\n");
+    out_printf("  title='Graph Title'       Title for the plot\n");
+    out_printf("  style='shade'             shade (default) or braille\n");
+    out_printf("  xmin= xmax= ymin= ymax=   Fixed axis bounds; points outside are skipped\n");
+    out_printf("  width=N height=N          Plot size in characters (default: terminal width, 20 rows)\n\n");
+
+    out_printf("Behavior:\n");
+    out_printf("  - Points are counted into a grid during the scan; only the grid is kept in memory.\n");
+    out_printf("  - Without all four bounds, a first pass finds the data range.\n");
+    out_printf("  - The Pearson correlation of the plotted points is printed below the chart.\n\n");
+
+    out_printf("Example:\n");
+    out_printf("  scatter file='assets/company.csv' x='year' y='salary' style='braille'\n\n");
+}
+
+void pivot_help()
+{
+    out_printf("\n=== Mathi Graphs: Pivot Command Help ===\n\n");
+
+    out_printf("Usage:\n");
+    out_printf("  pivot [options]\n\n");
+    out_printf("Description:\n");
+    out_printf("  Aggregate a numeric column over every pair of two dimension columns.\n\n");
+
+    out_printf("Required options:\n");
+    out_printf("  file='path/to/file.csv'   Specify the CSV file path (or data='name')\n");
+    out_printf("  rows='column_name'        Column whose values become the table rows\n");
+    out_printf("  cols='column_name'        Column whose values become the table columns\n");
+    out_printf("  val='column_name'         Numeric column to aggregate\n\n");
+
+    out_printf("Optional options:\n");
+    out_printf("  compute='method'          avg (default), sum, max, min\n");
+    out_printf("  where='year >= 2022'      Keep only matching rows, as for bar\n");
+    out_printf("  style='table'             table (default) or heatmap\n");
+    out_printf("  title='Table Title'       Title for the table\n\n");
+
+    out_printf("Behavior:\n");
+    out_printf("  - One scan fills the whole grid; each value is coded once and the codes index it.\n");
+    out_printf("  - Rows and columns are sorted by label; empty cells show '-'.\n");
+    out_printf("  - The grid holds at most %d cells.\n\n", PIVOT_MAX_CELLS);
+
+    out_printf("Example:\n");
+    out_printf("  pivot file='assets/company.csv' rows='department' cols='year' val='salary' compute='sum'\n\n");
+}
+
+void rollup_help()
+{
+    out_printf("\n=== Mathi Graphs: Rollup Command Help ===\n\n");
+
+    out_printf("Usage:\n");
+    out_printf("  rollup [options]\n\n");
+    out_printf("Description:\n");
+    out_printf("  Precompute the aggregates of a numeric column for every combination of\n");
+    out_printf("  a few dimension columns into a cube file, path/to/file.csv.cube.\n\n");
+
+    out_printf("Required options:\n");
+    out_printf("  file='path/to/file.csv'   Specify the CSV file path\n");
+    out_printf("  dims='year,department'    Dimension columns, comma-separated (at most %d)\n", CUBE_MAX_DIMS);
+    out_printf("  y='column_name'           Numeric column to aggregate\n\n");
+
+    out_printf("Optional options:\n");
+    out_printf("  depth=N                   Dims per combination, 1 to %d (default 2)\n\n", CUBE_MAX_DEPTH);
+
+    out_printf("Behavior:\n");
+    out_printf("  - One scan fills every combination; the cube keeps sum, count, min and max.\n");
+    out_printf("  - A later bar on the file whose y is the cube's, whose x is a dim and whose\n");
+    out_printf("    where= names only dims in one combination with x, is read from the cube\n");
+    out_printf("    without scanning the CSV (cube='0' scans anyway).\n");
+    out_printf("  - A cube older than its file is ignored with a warning; run rollup again.\n\n");
+
+    out_printf("Example:\n");
+    out_printf("  rollup file='assets/company.csv' dims='year,department,role' y='salary'\n\n");
+}
+
+void dataset_help()
+{
+    out_printf("\n=== Mathi Graphs: Dataset Commands Help ===\n\n");
+
+    out_printf("Usage:\n");
+    out_printf("  load name='name' file='path/to/file.csv'\n");
+    out_printf("  unload name='name'\n");
+    out_printf("  datasets\n");
+    out_printf("  schema file='path/to/file.csv'\n\n");
+    out_printf("Description:\n");
+    out_printf("  Parse a CSV file once into typed in-memory columns and query it by name.\n\n");
+
+    out_printf("Behavior:\n");
+    out_printf("  - Column types (int64, double, date, text) are sniffed from the first 1000\n");
+    out_printf("    rows and cached per file; schema prints them. A later row that does not\n");
+    out_printf("    fit widens its column, so every non-empty number keeps a column numeric.\n");
+    out_printf("  - Text columns keep each distinct value once; bar groups them by integer code.\n");
+    out_printf("  - bar data='name' reads the columns directly; the file is not opened again.\n");
+    out_printf("  - Text, int and date columns with at most %d distinct values get a bitmap\n", DATASET_INDEX_MAX_VALUES);
+    out_printf("    index, so where= on them (in bar and pivot) visits only the matching rows.\n");
+    out_printf("  - Loading an existing name replaces it; datasets lists rows and memory use.\n");
+    out_printf("  - The data is a snapshot: later changes to the file need another load.\n\n");
+
+    out_printf("Example:\n");
+    out_printf("  load name='company' file='assets/company.csv'\n");
+    out_printf("  bar data='company' x='year' y='salary' compute='sum'\n\n");
+}
+
+void prepare_help()
+{
+    out_printf("\n=== Mathi Graphs: Prepared Query Help ===\n\n");
+
+    out_printf("Usage:\n");
+    out_printf("  prepare NAME bar [options]\n");
+    out_printf("  run NAME [options]\n\n");
+    out_printf("Description:\n");
+    out_printf("  Parse and check a bar query once, then run it by name as often as needed.\n\n");
+
+    out_printf("Behavior:\n");
+    out_printf("  - prepare validates the options and resolves x, y and where columns against\n");
+    out_printf("    the file header, which is kept with the query.\n");
+    out_printf("  - Options given to run override the prepared ones for that run only.\n");
+    out_printf("  - If the file's size or modification time changed, the header is read again.\n");
+    out_printf("  - Preparing an existing name replaces it.\n\n");
+
+    out_printf("Example:\n");
+    out_printf("  prepare q1 bar file='assets/company.csv' x='department' y='salary'\n");
+    out_printf("  run q1 where='year >= 2022' compute='sum'\n\n");
+}
@@ -0,0 +1,197 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../headers/mathigraphs.h"
+
+#define DEFAULT_BINS 10
+#define MAX_BINS 1000
+
+// Helper: the lower edge of bin i. A range whose width overflows (such as
+// -1e308..1e308) takes a form that cannot.
+static double bin_edge(double lo, double hi, int i, int bins)
+{
+    double width = (hi - lo) / bins;
+    if (isfinite(width)) return lo + i * width;
+    double f = (double)i / bins;
+    return lo * (1 - f) + hi * f;
+}
+
+// Draw histogram: one counting pass, plus a range pass when min/max are not given
+void draw_hist(const HistOptions *opts)
+{
+    int bins = DEFAULT_BINS;
+    if (opts->bins && (mathi_str_to_int(opts->bins, &bins) != 0 || bins < 1 || bins > MAX_BINS))
+    {
+        out_printf("Error: bins must be between 1 and %d\n", MAX_BINS);
+        return;
+    }
+
+    double lo = 0, hi = 0;
+    int haveLo = 0, haveHi = 0;
+    if (opts->min)
+    {
+        if (!csv_number(opts->min, &lo) || !isfinite(lo)) { out_printf("Error: min is not a number -> %s\n", opts->min); return; }
+        haveLo = 1;
+    }
+    if (opts->max)
+    {
+        if (!csv_number(opts->max, &hi) || !isfinite(hi)) { out_printf("Error: max is not a number -> %s\n", opts->max); return; }
+        haveHi = 1;
+    }
+
+    CsvReader csv;
+    int rc = csv_open(&csv, opts->file);
+    if (rc != 0)
+    {
+        csv_open_error(rc, opts->file);
+        return;
+    }
+
+    int col = csv_find_column(&csv, opts->col);
+    if (col == -1)
+    {
+        out_printf("Error: column not found -> %s\n", opts->col);
+        csv_close(&csv);
+        return;
+    }
+
+    int nf;
+    double val;
+
+    // Range pass: only parses the one column, skipped when both bounds are given
+    if (!haveLo || !haveHi)
+    {
+        double seenLo = 0, seenHi = 0;
+        long seen = 0;
+        while ((nf = csv_next(&csv)) >= 0)
+        {
+            if (col >= nf || !csv_number(csv.fields[col], &val) || !isfinite(val)) continue;
+            if (seen == 0 || val < seenLo) seenLo = val;
+            if (seen == 0 || val > seenHi) seenHi = val;
+            seen++;
+        }
+        if (cancel_requested())
+        {
+            csv_close(&csv);
+            return;
+        }
+        if (seen == 0)
+        {
+            out_printf("No rows to plot.\n");
+            csv_close(&csv);
+            return;
+        }
+        if (!haveLo) lo = seenLo;
+        if (!haveHi) hi = seenHi;
+        csv_rewind(&csv);
+    }
+
+    if (hi < lo)
+    {
+        out_printf("Error: max must not be below min\n");
+        csv_close(&csv);
+        return;
+    }
+    if (hi == lo)
+    {
+        // single value: a range wide enough to differ from it at any magnitude
+        double pad = fabs(lo) * 1e-9 + 1;
+        if (isfinite(lo + pad)) hi = lo + pad;
+        else lo -= pad;
+    }
+
+    // Counting pass: O(bins) state, values are never stored
+    long *counts = calloc(bins, sizeof(long));
+    if (!counts)
+    {
+        out_printf("Error: out of memory\n");
+        csv_close(&csv);
+        return;
+    }
+
+    // halves keep the span finite when hi - lo overflows
+    double width = (hi - lo) / bins, half = hi / 2 - lo / 2;
+    int wide = !isfinite(width);
+    long outside = 0, nonfinite = 0;
+    while ((nf = csv_next(&csv)) >= 0)
+    {
+        if (col >= nf || !csv_number(csv.fields[col], &val)) continue;
+        if (!isfinite(val)) { nonfinite++; continue; } // nan and inf have no bin
+        if (val < lo || val > hi) { outside++; continue; }
+
+        int b = (int)(wide ? (val / 2 - lo / 2) / half * bins : (val - lo) / width);
+        if (b < 0) b = 0;
+        if (b >= bins) b = bins - 1; // the max value closes the last bin
+        counts[b]++;
+    }
+    csv_close(&csv);
+    if (cancel_requested())
+    {
+        free(counts);
+        return;
+    }
+
+    // Hand the bins to the bar renderer
+    char **labels = malloc(bins * sizeof(char *));
+    double *values = malloc(bins * sizeof(double));
+    if (!labels || !values)
+    {
+        out_printf("Error: out of memory\n");
+        free(labels); free(values); free(counts);
+        return;
+    }
+    for (int i = 0; i < bins; i++)
+    {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%.6g-%.6g", bin_edge(lo, hi, i, bins), bin_edge(lo, hi, i + 1, bins));
+        labels[i] = strdup(buf);
+        values[i] = (double)counts[i];
+    }
+
+    render_bars(opts->title, labels, values, NULL, bins);
+    if (outside > 0) out_printf("(%ld values outside [%g, %g] skipped)\n", outside, lo, hi);
+    if (nonfinite > 0) out_printf("(%ld nan or inf values skipped)\n", nonfinite);
+
+    for (int i = 0; i < bins; i++) free(labels[i]);
+    free(labels);
+    free(values);
+    free(counts);
+}
+
+// Display hist command
+void display_hist(char *command)
+{
+    HistOptions opts = {0}; // null all members
+    opts.file = get_option_value(command, "file=");
+    opts.col = get_option_value(command, "col=");
+    opts.bins = get_option_value(command, "bins=");
+    opts.min = get_option_value(command, "min=");
+    opts.max = get_option_value(command, "max=");
+    opts.title = get_option_value(command, "title=");
+
+    if (opts.col) mathi_string_to_lower(opts.col);
+
+    // Validate required
+    if (!opts.file || !opts.col)
+    {
+        out_printf("Missing required options: file, col\n");
+        goto cleanup;
+    }
+
+    if (!mathi_file_exists(opts.file))
+    {
+        out_printf("Error: file not found -> %s\n", opts.file);
+        goto cleanup;
+    }
+
+    draw_hist(&opts);
+
+cleanup:
+    free(opts.file);
+    free(opts.col);
+    free(opts.bins);
+    free(opts.min);
+    free(opts.max);
+    free(opts.title);
+}
@@ -0,0 +1,234 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../headers/mathigraphs.h"
+
+// Helper: append a string and its NUL to the build arena, 0 on success
+static int arena_put(Join *j, const char *s)
+{
+    size_t n = strlen(s) + 1;
+    if (j->len + n > j->cap)
+    {
+        size_t ncap = j->cap ? j->cap * 2 : 1 << 16;
+        while (ncap < j->len + n) ncap *= 2;
+        char *na = realloc(j->arena, ncap);
+        if (!na) return -1;
+        j->arena = na;
+        j->cap = ncap;
+    }
+    memcpy(j->arena + j->len, s, n);
+    j->len += n;
+    return 0;
+}
+
+// Helper: slot of a key in the table: its first build row, or the empty
+// slot where it would go
+static size_t key_slot(const Join *j, const char *key)
+{
+    size_t mask = j->tcap - 1;
+    size_t h = hash_text(key) & mask;
+    while (j->table[h] != -1 && strcmp(j->arena + j->rows[j->table[h]], key) != 0) h = (h + 1) & mask;
+    return h;
+}
+
+// Helper: double the table once it is half full
+static int table_grow(Join *j)
+{
+    size_t ncap = j->tcap * 2;
+    long *nt = malloc(ncap * sizeof(long));
+    if (!nt) return -1;
+    memset(nt, 0xff, ncap * sizeof(long));
+    for (size_t i = 0; i < j->tcap; i++)
+    {
+        if (j->table[i] == -1) continue;
+        size_t k = hash_text(j->arena + j->rows[j->table[i]]) & (ncap - 1);
+        while (nt[k] != -1) k = (k + 1) & (ncap - 1);
+        nt[k] = j->table[i];
+    }
+    free(j->table);
+    j->table = nt;
+    j->tcap = ncap;
+    return 0;
+}
+
+// Helper: store the build side's current row and hash its key. Rows with
+// an empty key never join, so they are not kept.
+static int build_row(Join *j, int nf)
+{
+    CsvReader *b = j->build;
+    const char *key = j->keyBuild < nf ? b->fields[j->keyBuild] : "";
+    if (key[0] == '\0') return 0;
+
+    if (j->nrows == j->rcap)
+    {
+        long ncap = j->rcap ? j->rcap * 2 : 4096;
+        size_t *nr = realloc(j->rows, ncap * sizeof(size_t));
+        if (!nr) return -1;
+        j->rows = nr;
+        long *nn = realloc(j->next, ncap * sizeof(long));
+        if (!nn) return -1;
+        j->next = nn;
+        j->rcap = ncap;
+    }
+    long r = j->nrows;
+    j->rows[r] = j->len;
+    if (arena_put(j, key) != 0) return -1;
+    for (int c = 0; c < b->ncols; c++)
+        if (arena_put(j, c < nf ? b->fields[c] : "") != 0) return -1;
+    j->nrows++;
+
+    // a repeated key chains after the first row that had it
+    size_t h = key_slot(j, j->arena + j->rows[r]);
+    if (j->table[h] != -1)
+    {
+        long first = j->table[h];
+        j->next[r] = j->next[first];
+        j->next[first] = r;
+        return 0;
+    }
+    j->table[h] = r;
+    j->next[r] = -1;
+    j->keys++;
+    return (size_t)j->keys * 2 >= j->tcap ? table_grow(j) : 0;
+}
+
+// Open the joined file and line up the columns of both sides; no data is
+// read yet (see join_build). The smaller file becomes the build side. Prints
+// the problem and returns -1 when the join cannot run; main is left open.
+int join_open(Join *j, CsvReader *main, const char *mainFile, const char *file, const char *key)
+{
+    memset(j, 0, sizeof(*j));
+    j->main = main;
+    j->match = -1;
+    int rc = csv_open(&j->other, file);
+    if (rc != 0)
+    {
+        csv_open_error(rc, file);
+        return -1;
+    }
+
+    int keyMain = csv_find_column(main, key);
+    int keyOther = csv_find_column(&j->other, key);
+    if (keyMain == -1 || keyOther == -1)
+    {
+        out_printf("Error: join key not found in both files -> on:%s\n", key);
+        join_close(j);
+        return -1;
+    }
+
+    j->ncols = main->ncols + j->other.ncols;
+    j->header = malloc(j->ncols * sizeof(char *));
+    j->fields = malloc(j->ncols * sizeof(char *));
+    j->tcap = 1024;
+    j->table = malloc(j->tcap * sizeof(long));
+    if (!j->header || !j->fields || !j->table)
+    {
+        out_printf("Error: out of memory\n");
+        join_close(j);
+        return -1;
+    }
+    memcpy(j->header, main->header, main->ncols * sizeof(char *));
+    memcpy(j->header + main->ncols, j->other.header, j->other.ncols * sizeof(char *));
+    memset(j->table, 0xff, j->tcap * sizeof(long));
+
+    if (mathi_file_size(mainFile) < mathi_file_size(file))
+    {
+        j->build = main;
+        j->probe = &j->other;
+        j->keyBuild = keyMain;
+        j->keyProbe = keyOther;
+        j->buildBase = 0;
+        j->probeBase = main->ncols;
+    }
+    else
+    {
+        j->build = &j->other;
+        j->probe = main;
+        j->keyBuild = keyOther;
+        j->keyProbe = keyMain;
+        j->buildBase = main->ncols;
+        j->probeBase = 0;
+    }
+    return 0;
+}
+
+// Read the whole build side into the hash table. Returns -1 when out of
+// memory or cancelled.
+int join_build(Join *j)
+{
+    int nf;
+    while ((nf = csv_next(j->build)) >= 0)
+    {
+        if (build_row(j, nf) != 0)
+        {
+            out_printf("Error: out of memory\n");
+            return -1;
+        }
+    }
+    if (cancel_requested()) return -1;
+    if (j->build == j->main)
+    {
+        j->hit = calloc(j->nrows ? j->nrows : 1, 1);
+        if (!j->hit)
+        {
+            out_printf("Error: out of memory\n");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Next joined row into j->fields, returns its field count or -1 at the end.
+// A probe row is repeated for every build row with its key; probe rows
+// without one are passed over (an inner join).
+int join_next(Join *j)
+{
+    while (j->match == -1)
+    {
+        int nf = csv_next(j->probe);
+        if (nf < 0) return -1;
+        const char *key = j->keyProbe < nf ? j->probe->fields[j->keyProbe] : "";
+        if (key[0] != '\0') j->match = j->table[key_slot(j, key)];
+        if (j->match == -1)
+        {
+            j->unmatched++;
+            continue;
+        }
+        for (int c = 0; c < j->probe->ncols; c++) j->fields[j->probeBase + c] = c < nf ? j->probe->fields[c] : "";
+    }
+
+    long r = j->match;
+    j->match = j->next[r];
+    if (j->hit) j->hit[r] = 1;
+    char *p = j->arena + j->rows[r];
+    p += strlen(p) + 1; // past the key
+    for (int c = 0; c < j->build->ncols; c++)
+    {
+        j->fields[j->buildBase + c] = p;
+        p += strlen(p) + 1;
+    }
+    return j->ncols;
+}
+
+// Rows of the query's file that joined with nothing, once the scan is done
+long join_unmatched(const Join *j)
+{
+    if (j->build != j->main) return j->unmatched;
+    long n = j->build->rows - j->nrows; // rows with an empty key were not kept
+    for (long r = 0; r < j->nrows; r++) n += !j->hit[r];
+    return n;
+}
+
+// Release the joined file and the hash table; the query's file stays open
+void join_close(Join *j)
+{
+    csv_close(&j->other);
+    free(j->header);
+    free(j->fields);
+    free(j->arena);
+    free(j->rows);
+    free(j->next);
+    free(j->table);
+    free(j->hit);
+    memset(j, 0, sizeof(*j));
+}
@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "../headers/mathigraphs.h"
+
+// Write a string with JSON escapes; bytes from 0x80 up pass through as UTF-8
+void json_write_string(const char *s)
+{
+    out_putchar('"');
+    for (const unsigned char *p = (const unsigned char *)s; *p; p++)
+    {
+        if (*p == '"' || *p == '\\') { out_putchar('\\'); out_putchar(*p); }
+        else if (*p == '\n') fputs("\\n", output_stream());
+        else if (*p == '\r') fputs("\\r", output_stream());
+        else if (*p == '\t') fputs("\\t", output_stream());
+        else if (*p < 0x20) out_printf("\\u%04x", *p);
+        else out_putchar(*p);
+    }
+    out_putchar('"');
+}
+
+// Write a number exactly. Counters and nanosecond timings are whole numbers
+// and print as integers; other values use the shortest round-trip form.
+void json_write_number(double d)
+{
+    if (!isfinite(d)) { fputs("null", output_stream()); return; }
+    if (d == floor(d) && fabs(d) < 9007199254740992.0) { out_printf("%.0f", d); return; }
+
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.15g", d);
+    if (strtod(buf, NULL) != d) snprintf(buf, sizeof(buf), "%.17g", d);
+    fputs(buf, output_stream());
+}
+
+// Helper: write one value and its children
+static void write_value(const MathiJSON *v)
+{
+    if (!v) { fputs("null", output_stream()); return; }
+    switch (v->type)
+    {
+        case JSON_NULL: fputs("null", output_stream()); break;
+        case JSON_BOOL: fputs(v->data.boolean ? "true" : "false", output_stream()); break;
+        case JSON_NUMBER: json_write_number(v->data.num); break;
+        case JSON_STRING: json_write_string(v->data.str ? v->data.str : ""); break;
+        case JSON_ARRAY:
+            out_putchar('[');
+            for (size_t i = 0; i < v->data.array.count; i++)
+            {
+                if (i) out_putchar(',');
+                write_value(v->data.array.items[i]);
+            }
+            out_putchar(']');
+            break;
+        case JSON_OBJECT:
+            out_putchar('{');
+            json_write_members(v);
+            out_putchar('}');
+            break;
+    }
+}
+
+// Write the members of an object without its braces, so a caller can stream
+// more members after them
+void json_write_members(const MathiJSON *obj)
+{
+    for (size_t i = 0; i < obj->data.object.count; i++)
+    {
+        if (i) out_putchar(',');
+        json_write_string(obj->data.object.keys[i]);
+        out_putchar(':');
+        write_value(obj->data.object.values[i]);
+    }
+}
+
+// Write one value without a newline
+void json_write(const MathiJSON *value)
+{
+    write_value(value);
+}
+
+// Print a mathison tree as one line of JSON. mathison_serialize is not used
+// because it prints numbers with %g (six digits) and does not escape strings.
+void json_print(const MathiJSON *value)
+{
+    write_value(value);
+    out_putchar('\n');
+}
@@ -0,0 +1,306 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../headers/mathigraphs.h"
+
+#define LABEL_WIDTH 12
+#define DEFAULT_HEIGHT 20
+
+typedef struct {
+    double sx;
+    double sy;
+    long n;
+} Bucket;
+
+// Helper: next (x, y) point of the scan, 0 at end of file, -1 when out of
+// memory. X may also be an ISO-8601 timestamp, which is read as epoch
+// seconds and flagged in *timeX. With a window, y becomes the window's
+// value for compute= as of this point. Points with a nan or inf coordinate
+// are skipped.
+static int next_point(CsvReader *csv, int colX, int colY, Point *p, int *timeX, Rolling *win, const char *compute)
+{
+    int nf;
+    long long t;
+    while ((nf = csv_next(csv)) >= 0)
+    {
+        if (colX >= nf || colY >= nf) continue;
+        if (!csv_number(csv->fields[colY], &p->y) || !isfinite(p->y)) continue;
+        if (!csv_number(csv->fields[colX], &p->x))
+        {
+            if (!ts_parse(csv->fields[colX], &t)) continue;
+            p->x = (double)t;
+            *timeX = 1;
+        }
+        if (!isfinite(p->x)) continue;
+
+        if (win)
+        {
+            WindowEntry e = {p->x, p->y, p->y * p->y, 1, p->y, p->y, 0};
+            if (rolling_push(win, &e) != 0)
+            {
+                out_printf("Error: out of memory\n");
+                return -1;
+            }
+            p->y = rolling_value(win, compute);
+        }
+        return 1;
+    }
+    return 0;
+}
+
+// Helper: plot a straight segment between two grid cells
+static void plot_segment(char *grid, int w, int c0, int r0, int c1, int r1)
+{
+    int dc = c1 > c0 ? c1 - c0 : c0 - c1, sc = c0 < c1 ? 1 : -1;
+    int dr = r1 > r0 ? r0 - r1 : r1 - r0, sr = r0 < r1 ? 1 : -1;
+    int err = dc + dr;
+    while (1)
+    {
+        grid[r0 * w + c0] = '*';
+        if (c0 == c1 && r0 == r1) break;
+        int e2 = 2 * err;
+        if (e2 >= dr) { err += dr; c0 += sc; }
+        if (e2 <= dc) { err += dc; r0 += sr; }
+    }
+}
+
+// Render downsampled points as a line chart of w x h cells
+static void render_line(const char *title, const Point *pts, int n, int w, int h, int timeX, double minX, double maxX, double minY, double maxY)
+{
+    char *grid = malloc((size_t)w * h);
+    if (!grid) { out_printf("Error: out of memory\n"); return; }
+    memset(grid, ' ', (size_t)w * h);
+
+    double spanX = maxX > minX ? maxX - minX : 1;
+    double spanY = maxY > minY ? maxY - minY : 1;
+    int pc = 0, pr = 0;
+    for (int i = 0; i < n; i++)
+    {
+        int c = (int)((pts[i].x - minX) / spanX * (w - 1) + 0.5);
+        int r = (h - 1) - (int)((pts[i].y - minY) / spanY * (h - 1) + 0.5);
+        if (i == 0) grid[r * w + c] = '*';
+        else plot_segment(grid, w, pc, pr, c, r);
+        pc = c;
+        pr = r;
+    }
+
+    if (title) out_printf("\n%s\n\n", title);
+    for (int r = 0; r < h; r++)
+    {
+        if (r == 0) out_printf("%*.6g |", LABEL_WIDTH - 2, maxY);
+        else if (r == h - 1) out_printf("%*.6g |", LABEL_WIDTH - 2, minY);
+        else out_printf("%*s |", LABEL_WIDTH - 2, "");
+        fwrite(grid + (size_t)r * w, 1, w, output_stream());
+        out_printf("\n");
+    }
+    out_printf("%*s +", LABEL_WIDTH - 2, "");
+    for (int c = 0; c < w; c++) out_putchar('-');
+    if (timeX)
+    {
+        char lo[32], hi[32];
+        ts_format((long long)minX, 1, lo, sizeof(lo));
+        ts_format((long long)maxX, 1, hi, sizeof(hi));
+        out_printf("\n%*s  %-*s%*s\n\n", LABEL_WIDTH - 2, "", w / 2, lo, w - w / 2, hi);
+    }
+    else out_printf("\n%*s  %-*.6g%*.6g\n\n", LABEL_WIDTH - 2, "", w / 2, minX, w - w / 2, maxX);
+    free(grid);
+}
+
+// Draw line chart: Largest-Triangle-Three-Buckets over two streaming passes
+void draw_line(const LineOptions *opts)
+{
+    int cols, rows;
+    term_size(&cols, &rows);
+    int w = term_option(opts->width, cols - LABEL_WIDTH - 1, 10, 1000);
+    int h = term_option(opts->height, DEFAULT_HEIGHT, 4, 200);
+
+    if (opts->compute && strcmp(opts->compute, "avg") != 0 && strcmp(opts->compute, "sum") != 0 &&
+        strcmp(opts->compute, "max") != 0 && strcmp(opts->compute, "min") != 0)
+    {
+        out_printf("Error: unknown compute '%s'.\n", opts->compute);
+        return;
+    }
+    WindowSpec spec;
+    if (opts->window && !window_parse(opts->window, &spec))
+    {
+        out_printf("Error: unknown window '%s'. Use a count such as 30, or a span such as 15m, 1h, 7d\n", opts->window);
+        return;
+    }
+    if (opts->compute && !opts->window) out_printf("Warning: compute applies to window= only. Ignored.\n");
+
+    CsvReader csv;
+    int rc = csv_open(&csv, opts->file);
+    if (rc != 0)
+    {
+        csv_open_error(rc, opts->file);
+        return;
+    }
+
+    int colX = csv_find_column(&csv, opts->x);
+    int colY = csv_find_column(&csv, opts->y);
+    if (colX == -1 || colY == -1)
+    {
+        out_printf("Error: columns not found -> x:%s y:%s\n", opts->x, opts->y);
+        csv_close(&csv);
+        return;
+    }
+
+    // Pass 1: bucket averages without knowing the row count. Buckets hold
+    // `size` points each; when they run out, neighbours merge and size doubles,
+    // so at most 2*w buckets ever exist.
+    int maxb = 2 * w;
+    Bucket *buckets = calloc(maxb, sizeof(Bucket));
+    Point *out = malloc((maxb + 2) * sizeof(Point));
+    Rolling window, *win = NULL;
+    if (opts->window && rolling_init(&window, &spec) == 0) win = &window;
+    if (!buckets || !out || (opts->window && !win))
+    {
+        out_printf("Error: out of memory\n");
+        free(buckets); free(out);
+        if (win) rolling_free(win);
+        csv_close(&csv);
+        return;
+    }
+
+    long size = 1, npts = 0, backwards = 0;
+    int timeX = 0;
+    Point p, first = {0, 0}, last = {0, 0};
+    double minX = 0, maxX = 0, minY = 0, maxY = 0;
+    while ((rc = next_point(&csv, colX, colY, &p, &timeX, win, opts->compute)) > 0)
+    {
+        long k = npts / size;
+        if (k >= maxb)
+        {
+            for (int j = 0; j < maxb / 2; j++)
+            {
+                buckets[j].sx = buckets[2 * j].sx + buckets[2 * j + 1].sx;
+                buckets[j].sy = buckets[2 * j].sy + buckets[2 * j + 1].sy;
+                buckets[j].n = buckets[2 * j].n + buckets[2 * j + 1].n;
+            }
+            memset(buckets + maxb / 2, 0, (maxb - maxb / 2) * sizeof(Bucket));
+            size *= 2;
+            k = npts / size;
+        }
+        buckets[k].sx += p.x;
+        buckets[k].sy += p.y;
+        buckets[k].n++;
+
+        if (npts == 0) { first = p; minX = maxX = p.x; minY = maxY = p.y; }
+        if (p.x < minX) minX = p.x;
+        if (p.x > maxX) maxX = p.x;
+        if (p.y < minY) minY = p.y;
+        if (p.y > maxY) maxY = p.y;
+        if (npts > 0 && p.x < last.x) backwards++;
+        last = p;
+        npts++;
+    }
+
+    if (rc < 0 || cancel_requested())
+    {
+        free(buckets); free(out);
+        if (win) rolling_free(win);
+        csv_close(&csv);
+        return;
+    }
+    if (npts == 0)
+    {
+        out_printf("No rows to plot.\n");
+        free(buckets); free(out);
+        if (win) rolling_free(win);
+        csv_close(&csv);
+        return;
+    }
+    if (win && backwards > 0) out_printf("Warning: x goes back %ld times; window= follows file order\n", backwards);
+
+    // Pass 2: per bucket keep the point forming the largest triangle with the
+    // previously selected point and the average of the next bucket.
+    int nb = (int)((npts + size - 1) / size);
+    int nout = 0;
+    out[nout++] = first;
+    Point a = first, best = first;
+    double bestArea = -1;
+    long cur = 0, i = 0;
+    csv_rewind(&csv);
+    if (win) rolling_reset(win);
+    while (i < npts && (rc = next_point(&csv, colX, colY, &p, &timeX, win, opts->compute)) > 0)
+    {
+        long k = i / size;
+        if (k != cur)
+        {
+            if (bestArea >= 0) { out[nout++] = best; a = best; }
+            cur = k;
+            bestArea = -1;
+        }
+
+        if (i > 0 && i < npts - 1)
+        {
+            Point c = last;
+            if (k + 1 < nb) { c.x = buckets[k + 1].sx / buckets[k + 1].n; c.y = buckets[k + 1].sy / buckets[k + 1].n; }
+            double area = (a.x - c.x) * (p.y - a.y) - (a.x - p.x) * (c.y - a.y);
+            if (area < 0) area = -area;
+            if (area > bestArea) { bestArea = area; best = p; }
+        }
+        i++;
+    }
+    if (bestArea >= 0) out[nout++] = best;
+    if (npts > 1) out[nout++] = last;
+    csv_close(&csv);
+    if (win) rolling_free(win);
+    if (rc < 0 || cancel_requested())
+    {
+        free(buckets); free(out);
+        return;
+    }
+
+    render_line(opts->title, out, nout, w, h, timeX, minX, maxX, minY, maxY);
+    if (opts->window) out_printf("(%ld points, %d plotted, rolling %s over window %s)\n", npts, nout, opts->compute ? opts->compute : "avg", opts->window);
+    else out_printf("(%ld points, %d plotted)\n", npts, nout);
+
+    free(buckets);
+    free(out);
+}
+
+// Display line command
+void display_line(char *command)
+{
+    LineOptions opts = {0}; // null all members
+    opts.file = get_option_value(command, "file=");
+    opts.x = get_option_value(command, "x=");
+    opts.y = get_option_value(command, "y=");
+    opts.title = get_option_value(command, "title=");
+    opts.width = get_option_value(command, "width=");
+    opts.height = get_option_value(command, "height=");
+    opts.window = get_option_value(command, "window=");
+    opts.compute = get_option_value(command, "compute=");
+
+    if (opts.x) mathi_string_to_lower(opts.x);
+    if (opts.y) mathi_string_to_lower(opts.y);
+    if (opts.window) mathi_string_to_lower(opts.window);
+    if (opts.compute) mathi_string_to_lower(opts.compute);
+
+    // Validate required
+    if (!opts.file || !opts.x || !opts.y)
+    {
+        out_printf("Missing required options: file, x, y\n");
+        goto cleanup;
+    }
+
+    if (!mathi_file_exists(opts.file))
+    {
+        out_printf("Error: file not found -> %s\n", opts.file);
+        goto cleanup;
+    }
+
+    draw_line(&opts);
+
+cleanup:
+    free(opts.file);
+    free(opts.x);
+    free(opts.y);
+    free(opts.title);
+    free(opts.width);
+    free(opts.height);
+    free(opts.window);
+    free(opts.compute);
+}
@@ -0,0 +1,149 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <malloc.h>
+#include "../headers/mathigraphs.h"
+
+#ifndef __GLIBC__
+#error "memtrack.c wraps glibc's __libc_* allocator entry points and needs glibc"
+#endif
+
+// The allocator hook: these definitions replace malloc, calloc, realloc,
+// free and the aligned allocators for the whole process, so libmathi and libc
+// internals (getline, strdup, stdio buffers) are counted along with our own
+// code. They forward to glibc's allocator and only touch the counters while
+// tracking is on. Every allocator that free may be handed a block from is
+// wrapped, so frees always balance allocations.
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t n, size_t size);
+void *__libc_realloc(void *p, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void __libc_free(void *p);
+
+// Tracking and the counters belong to the thread: a command runs on one
+// thread from start to end, so each server worker counts only the command
+// it is running, for the session that turned memstats on.
+static _Thread_local int tracking;
+static _Thread_local long allocs;
+static _Thread_local long frees;
+static _Thread_local long long in_use;
+static _Thread_local long long peak;
+
+// Helper: account for one new block
+static void count_alloc(void *p)
+{
+    allocs++;
+    in_use += (long long)malloc_usable_size(p);
+    if (in_use > peak) peak = in_use;
+}
+
+// Helper: account for size bytes more (or less) and raise the high-water mark
+static void count_bytes(long long delta)
+{
+    in_use += delta;
+    if (in_use > peak) peak = in_use;
+}
+
+void *malloc(size_t size)
+{
+    void *p = __libc_malloc(size);
+    if (p && tracking) count_alloc(p);
+    return p;
+}
+
+void *calloc(size_t n, size_t size)
+{
+    void *p = __libc_calloc(n, size);
+    if (p && tracking) count_alloc(p);
+    return p;
+}
+
+void *realloc(void *p, size_t size)
+{
+    if (!tracking) return __libc_realloc(p, size);
+
+    long long before = p ? (long long)malloc_usable_size(p) : 0;
+    void *np = __libc_realloc(p, size);
+    if (np)
+    {
+        if (!p) allocs++;
+        count_bytes((long long)malloc_usable_size(np) - before);
+    }
+    else if (p && size == 0)
+    {
+        frees++;
+        count_bytes(-before);
+    }
+    return np;
+}
+
+void *memalign(size_t alignment, size_t size)
+{
+    void *p = __libc_memalign(alignment, size);
+    if (p && tracking) count_alloc(p);
+    return p;
+}
+
+void *aligned_alloc(size_t alignment, size_t size)
+{
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void **out, size_t alignment, size_t size)
+{
+    if (alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0) return EINVAL;
+    int saved = errno; // posix_memalign reports through its result only
+    void *p = memalign(alignment, size);
+    errno = saved;
+    if (!p) return ENOMEM;
+    *out = p;
+    return 0;
+}
+
+void free(void *p)
+{
+    if (p && tracking)
+    {
+        frees++;
+        count_bytes(-(long long)malloc_usable_size(p));
+    }
+    __libc_free(p);
+}
+
+// Turn counting on or off for this thread; off costs one load per allocator
+// call
+void mem_tracking(int on)
+{
+    tracking = on ? 1 : 0;
+}
+
+int mem_tracking_enabled(void)
+{
+    return tracking;
+}
+
+// Start counting from zero, e.g. at the start of a command. Memory freed
+// afterwards that was allocated before shows up as negative bytes in use.
+void mem_reset(void)
+{
+    allocs = 0;
+    frees = 0;
+    in_use = 0;
+    peak = 0;
+}
+
+// Copy this thread's counters
+void mem_snapshot(MemStats *m)
+{
+    m->allocs = allocs;
+    m->frees = frees;
+    m->in_use = in_use;
+    m->peak = peak;
+}
+
+// Print the counters of one command
+void mem_report(const MemStats *m)
+{
+    out_printf("memory: %ld allocs, %ld frees, %lld bytes still in use, peak %lld bytes\n",
+               m->allocs, m->frees, m->in_use, m->peak);
+}
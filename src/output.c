@@ -0,0 +1,33 @@
+#include <stdio.h>
+#include <stdarg.h>
+#include "../headers/mathigraphs.h"
+
+static _Thread_local FILE *captured;
+
+// Stream that command output of this thread goes to
+FILE *output_stream(void)
+{
+    return captured ? captured : stdout;
+}
+
+// Send this thread's output to stream, or back to stdout with NULL
+void output_capture(FILE *stream)
+{
+    captured = stream;
+}
+
+// printf to this thread's output stream
+int out_printf(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int n = vfprintf(output_stream(), format, args);
+    va_end(args);
+    return n;
+}
+
+// putchar to this thread's output stream
+int out_putchar(int c)
+{
+    return putc(c, output_stream());
+}
@@ -0,0 +1,435 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../headers/mathigraphs.h"
+
+#define LABEL_WIDTH 24
+#define HEAT_WIDTH 8
+
+static const char SHADES[] = " .:-=+*#%@";
+
+// A dimension of the grid: dataset text columns index it with their own
+// dictionary codes; other columns get codes from a group table of the
+// values seen, in order of first appearance
+typedef struct {
+    int col;
+    int text;
+    GroupTable t;
+} PivotDim;
+
+// The aggregates, row-major in rcap x ccap cells; a cell with count 0 is empty
+typedef struct {
+    Group *cells;
+    int rcap;
+    int ccap;
+} PivotGrid;
+
+// A dimension value and its code, for sorting labels for display
+typedef struct {
+    const char *label;
+    int code;
+} PivotLabel;
+
+// Helper: the value a cell shows for compute=, as bar computes it
+static double cell_value(const Group *g, const char *compute)
+{
+    if (!compute || strcmp(compute, "avg") == 0) return g->sum / g->count;
+    if (strcmp(compute, "sum") == 0) return g->sum;
+    if (strcmp(compute, "max") == 0) return g->max;
+    return g->min;
+}
+
+// Helper: code of a row's value in a dimension, -1 when out of memory
+static int dim_code(PivotDim *d, const Dataset *ds, long row, const char *value)
+{
+    if (d->text) return (int)ds->cols[d->col].codes[row];
+    Group *g = group_table_get(&d->t, value);
+    return g ? (int)(g - d->t.groups) : -1;
+}
+
+// Helper: number of codes a dimension has handed out (or could)
+static int dim_count(const PivotDim *d, const Dataset *ds)
+{
+    return d->text ? (int)ds->cols[d->col].ndict : d->t.gcount;
+}
+
+// Helper: the label of a code
+static const char *dim_label(const PivotDim *d, const Dataset *ds, int code)
+{
+    return d->text ? ds->cols[d->col].dict[code] : d->t.groups[code].label;
+}
+
+// Helper: make room for cell (r, c), doubling whichever side is short.
+// Returns -1 when out of memory or past PIVOT_MAX_CELLS.
+static int grid_fit(PivotGrid *g, int r, int c, int nrows, int ncols)
+{
+    if (r < g->rcap && c < g->ccap) return 0;
+    if ((long long)nrows * ncols > PIVOT_MAX_CELLS)
+    {
+        out_printf("Error: pivot has more than %d cells; pick rows and cols with fewer values\n", PIVOT_MAX_CELLS);
+        return -1;
+    }
+    int rcap = g->rcap ? g->rcap : 16, ccap = g->ccap ? g->ccap : 16;
+    while (rcap <= r) rcap *= 2;
+    while (ccap <= c) ccap *= 2;
+    Group *cells = calloc((size_t)rcap * ccap, sizeof(Group));
+    if (!cells)
+    {
+        out_printf("Error: out of memory\n");
+        return -1;
+    }
+    for (int i = 0; i < g->rcap; i++) memcpy(cells + (size_t)i * ccap, g->cells + (size_t)i * g->ccap, g->ccap * sizeof(Group));
+    free(g->cells);
+    g->cells = cells;
+    g->rcap = rcap;
+    g->ccap = ccap;
+    return 0;
+}
+
+// Helper: order of two labels, numbers before text
+static int pivot_label_order(const void *a, const void *b)
+{
+    return csv_label_order(((const PivotLabel *)a)->label, ((const PivotLabel *)b)->label);
+}
+
+// Helper: the codes of a dimension that have at least one row, sorted by
+// label; returns how many, -1 when out of memory
+static int dim_sorted(const PivotDim *d, const Dataset *ds, const PivotGrid *g, int rowsSide, PivotLabel **out)
+{
+    int n = dim_count(d, ds), kept = 0;
+    PivotLabel *labels = malloc((n ? n : 1) * sizeof(PivotLabel));
+    if (!labels) return -1;
+    for (int i = 0; i < n; i++)
+    {
+        int used = 0;
+        if (rowsSide)
+            for (int j = 0; !used && i < g->rcap && j < g->ccap; j++) used = g->cells[(size_t)i * g->ccap + j].count > 0;
+        else
+            for (int j = 0; !used && i < g->ccap && j < g->rcap; j++) used = g->cells[(size_t)j * g->ccap + i].count > 0;
+        if (!used) continue;
+        labels[kept].label = dim_label(d, ds, i);
+        labels[kept].code = i;
+        kept++;
+    }
+    qsort(labels, kept, sizeof(PivotLabel), pivot_label_order);
+    *out = labels;
+    return kept;
+}
+
+// Render the grid as a table of values, '-' for empty cells
+static void render_table(const PivotOptions *opts, const PivotGrid *g, const PivotLabel *rows, int nr, const PivotLabel *cols, int nc)
+{
+    int lw = (int)strlen(opts->rows);
+    for (int i = 0; i < nr; i++)
+        if ((int)strlen(rows[i].label) > lw) lw = (int)strlen(rows[i].label);
+    if (lw > LABEL_WIDTH) lw = LABEL_WIDTH;
+
+    int *widths = malloc((nc ? nc : 1) * sizeof(int));
+    if (!widths) { out_printf("Error: out of memory\n"); return; }
+    int total = lw + 2;
+    for (int j = 0; j < nc; j++)
+    {
+        widths[j] = (int)strlen(cols[j].label);
+        for (int i = 0; i < nr; i++)
+        {
+            const Group *cell = &g->cells[(size_t)rows[i].code * g->ccap + cols[j].code];
+            int len = cell->count ? snprintf(NULL, 0, "%.2f", cell_value(cell, opts->compute)) : 1;
+            if (len > widths[j]) widths[j] = len;
+        }
+        total += widths[j] + 2;
+    }
+
+    if (opts->title) out_printf("\n%s\n\n", opts->title);
+    out_printf("%-*.*s |", lw, lw, opts->rows);
+    for (int j = 0; j < nc; j++) out_printf("  %*s", widths[j], cols[j].label);
+    out_printf("\n");
+    for (int k = 0; k < total; k++) out_putchar(k == lw + 1 ? '+' : '-');
+    out_printf("\n");
+    for (int i = 0; i < nr; i++)
+    {
+        out_printf("%-*.*s |", lw, lw, rows[i].label);
+        for (int j = 0; j < nc; j++)
+        {
+            const Group *cell = &g->cells[(size_t)rows[i].code * g->ccap + cols[j].code];
+            if (cell->count) out_printf("  %*.2f", widths[j], cell_value(cell, opts->compute));
+            else out_printf("  %*s", widths[j], "-");
+        }
+        out_printf("\n");
+    }
+    out_printf("\n");
+    free(widths);
+}
+
+// Helper: the shade of a cell value between lo and hi, blank for nan or inf.
+// Halves keep the span finite when hi - lo overflows (-1e308..1e308).
+static int heat_level(double v, double lo, double hi)
+{
+    if (!isfinite(v)) return 0;
+    int top = (int)sizeof(SHADES) - 2;
+    double pos = 0;
+    if (isfinite(hi - lo)) pos = hi > lo ? (v - lo) / (hi - lo) : 0;
+    else pos = (v / 2 - lo / 2) / (hi / 2 - lo / 2);
+    int level = 1 + (int)(pos * (top - 1));
+    if (level < 1) level = 1;
+    if (level > top) level = top;
+    return level;
+}
+
+// Render the grid as shades from the lowest value to the highest, blank for
+// empty cells and cells whose value is nan or inf. Column labels longer than
+// HEAT_WIDTH are written downwards.
+static void render_heatmap(const PivotOptions *opts, const PivotGrid *g, const PivotLabel *rows, int nr, const PivotLabel *cols, int nc)
+{
+    int lw = (int)strlen(opts->rows);
+    for (int i = 0; i < nr; i++)
+        if ((int)strlen(rows[i].label) > lw) lw = (int)strlen(rows[i].label);
+    if (lw > LABEL_WIDTH) lw = LABEL_WIDTH;
+
+    int cw = 3;
+    for (int j = 0; j < nc; j++)
+        if ((int)strlen(cols[j].label) > cw) cw = (int)strlen(cols[j].label);
+    int down = cw > HEAT_WIDTH ? (cw < LABEL_WIDTH ? cw : LABEL_WIDTH) : 0;
+    if (down) cw = 2;
+
+    double lo = 0, hi = 0;
+    int seen = 0;
+    for (int i = 0; i < nr; i++)
+    {
+        for (int j = 0; j < nc; j++)
+        {
+            const Group *cell = &g->cells[(size_t)rows[i].code * g->ccap + cols[j].code];
+            if (!cell->count) continue;
+            double v = cell_value(cell, opts->compute);
+            if (!isfinite(v)) continue;
+            if (!seen || v < lo) lo = v;
+            if (!seen || v > hi) hi = v;
+            seen = 1;
+        }
+    }
+
+    if (opts->title) out_printf("\n%s\n\n", opts->title);
+    if (down)
+    {
+        for (int k = 0; k < down; k++)
+        {
+            out_printf("%-*.*s |", lw, lw, k == down - 1 ? opts->rows : "");
+            for (int j = 0; j < nc; j++)
+            {
+                char ch = k < (int)strlen(cols[j].label) ? cols[j].label[k] : ' ';
+                out_printf(" %c%*s", ch, cw - 1, "");
+            }
+            out_printf("\n");
+        }
+    }
+    else
+    {
+        out_printf("%-*.*s |", lw, lw, opts->rows);
+        for (int j = 0; j < nc; j++) out_printf(" %-*s", cw, cols[j].label);
+        out_printf("\n");
+    }
+    for (int i = 0; i < nr; i++)
+    {
+        out_printf("%-*.*s |", lw, lw, rows[i].label);
+        for (int j = 0; j < nc; j++)
+        {
+            const Group *cell = &g->cells[(size_t)rows[i].code * g->ccap + cols[j].code];
+            int level = cell->count ? heat_level(cell_value(cell, opts->compute), lo, hi) : 0;
+            out_putchar(' ');
+            for (int k = 0; k < cw; k++) out_putchar(SHADES[level]);
+        }
+        out_printf("\n");
+    }
+    out_printf("\n(shades from '%c' = %.2f to '%c' = %.2f)\n", SHADES[1], lo, SHADES[sizeof(SHADES) - 2], hi);
+}
+
+// Draw pivot: one scan fills a rows x cols grid of aggregates, each row
+// placed by the codes of its two dimension values
+void draw_pivot(const PivotOptions *opts)
+{
+    if (opts->compute && strcmp(opts->compute, "avg") != 0 && strcmp(opts->compute, "sum") != 0 &&
+        strcmp(opts->compute, "max") != 0 && strcmp(opts->compute, "min") != 0)
+    {
+        out_printf("Error: unknown compute '%s'.\n", opts->compute);
+        return;
+    }
+    int heatmap = 0;
+    if (opts->style && strcmp(opts->style, "heatmap") == 0) heatmap = 1;
+    else if (opts->style && strcmp(opts->style, "table") != 0)
+    {
+        out_printf("Warning: unknown style '%s'. Using table.\n", opts->style);
+    }
+
+    CsvReader csv;
+    Dataset *ds = NULL;
+    char **header;
+    int ncols;
+    if (opts->data)
+    {
+        ds = dataset_acquire(opts->data);
+        if (!ds)
+        {
+            out_printf("Error: dataset not loaded -> %s\n", opts->data);
+            return;
+        }
+        header = ds->header;
+        ncols = ds->ncols;
+    }
+    else
+    {
+        int rc = csv_open(&csv, opts->file);
+        if (rc != 0)
+        {
+            csv_open_error(rc, opts->file);
+            return;
+        }
+        header = csv.header;
+        ncols = csv.ncols;
+    }
+
+    PivotDim rows = {-1, 0, {0}}, cols = {-1, 0, {0}};
+    int colVal = -1;
+    for (int c = 0; c < ncols; c++)
+    {
+        if (rows.col == -1 && strcmp(header[c], opts->rows) == 0) rows.col = c;
+        if (cols.col == -1 && strcmp(header[c], opts->cols) == 0) cols.col = c;
+        if (colVal == -1 && strcmp(header[c], opts->val) == 0) colVal = c;
+    }
+    Where where = {0};
+    PivotGrid grid = {0};
+    PivotLabel *rowLabels = NULL, *colLabels = NULL;
+    long used = 0, rejected = 0;
+    int failed = 0;
+    double v;
+    if (rows.col == -1 || cols.col == -1 || colVal == -1)
+    {
+        out_printf("Error: columns not found -> rows:%s cols:%s val:%s\n", opts->rows, opts->cols, opts->val);
+        goto cleanup;
+    }
+    if (opts->where && (where_parse(opts->where, &where) != 0 || where_bind(&where, header, ncols) != 0)) goto cleanup;
+
+    if (ds)
+    {
+        rows.text = ds->cols[rows.col].type == COLUMN_TEXT;
+        cols.text = ds->cols[cols.col].type == COLUMN_TEXT;
+        char rbuf[32], cbuf[32];
+        WhereScan scan;
+        where_scan_start(&scan, &where, ds);
+        long r;
+        while (!failed && (r = where_scan_next(&scan)) >= 0)
+        {
+            if (!dataset_number(ds, colVal, r, &v)) { rejected++; continue; }
+            int i = dim_code(&rows, ds, r, dataset_text(ds, rows.col, r, rbuf, sizeof(rbuf)));
+            int j = dim_code(&cols, ds, r, dataset_text(ds, cols.col, r, cbuf, sizeof(cbuf)));
+            if (i < 0 || j < 0) { out_printf("Error: out of memory\n"); failed = 1; break; }
+            if (grid_fit(&grid, i, j, dim_count(&rows, ds), dim_count(&cols, ds)) != 0) { failed = 1; break; }
+            group_add(&grid.cells[(size_t)i * grid.ccap + j], v);
+            used++;
+        }
+        where_scan_end(&scan);
+    }
+    else
+    {
+        // the sniffed type of val picks the number parser
+        SchemaType *types = malloc(ncols * sizeof(SchemaType));
+        SchemaType typeVal = SCHEMA_EMPTY;
+        if (types && schema_get(opts->file, types, ncols) == 0) typeVal = types[colVal];
+        free(types);
+
+        int nf;
+        while ((nf = csv_next(&csv)) >= 0)
+        {
+            if (where.nclauses > 0 && !where_match(&where, csv.fields, nf)) continue;
+            if (rows.col >= nf || cols.col >= nf || colVal >= nf || !schema_number(typeVal, csv.fields[colVal], &v))
+            {
+                rejected++;
+                continue;
+            }
+            int i = dim_code(&rows, NULL, 0, csv.fields[rows.col]);
+            int j = dim_code(&cols, NULL, 0, csv.fields[cols.col]);
+            if (i < 0 || j < 0) { out_printf("Error: out of memory\n"); failed = 1; break; }
+            if (grid_fit(&grid, i, j, rows.t.gcount, cols.t.gcount) != 0) { failed = 1; break; }
+            group_add(&grid.cells[(size_t)i * grid.ccap + j], v);
+            used++;
+        }
+    }
+    if (failed || cancel_requested()) goto cleanup;
+    if (used == 0)
+    {
+        out_printf("No rows to plot.\n");
+        if (rejected > 0) out_printf("(%ld rows without a numeric %s skipped)\n", rejected, opts->val);
+        goto cleanup;
+    }
+
+    int nr = dim_sorted(&rows, ds, &grid, 1, &rowLabels);
+    int nc = dim_sorted(&cols, ds, &grid, 0, &colLabels);
+    if (nr < 0 || nc < 0) out_printf("Error: out of memory\n");
+    else
+    {
+        if (heatmap) render_heatmap(opts, &grid, rowLabels, nr, colLabels, nc);
+        else render_table(opts, &grid, rowLabels, nr, colLabels, nc);
+        out_printf("(%ld rows in %d x %d cells)\n", used, nr, nc);
+        if (rejected > 0) out_printf("(%ld rows without a numeric %s skipped)\n", rejected, opts->val);
+    }
+
+cleanup:
+    free(rowLabels);
+    free(colLabels);
+    free(grid.cells);
+    group_table_free(&rows.t);
+    group_table_free(&cols.t);
+    where_free(&where);
+    if (ds) dataset_release(ds);
+    else csv_close(&csv);
+}
+
+// Display pivot command
+void display_pivot(char *command)
+{
+    PivotOptions opts = {0}; // null all members
+    opts.file = get_option_value(command, "file=");
+    opts.data = get_option_value(command, "data=");
+    opts.rows = get_option_value(command, "rows=");
+    opts.cols = get_option_value(command, "cols=");
+    opts.val = get_option_value(command, "val=");
+    opts.compute = get_option_value(command, "compute=");
+    opts.where = get_option_value(command, "where=");
+    opts.style = get_option_value(command, "style=");
+    opts.title = get_option_value(command, "title=");
+
+    if (opts.rows) mathi_string_to_lower(opts.rows);
+    if (opts.cols) mathi_string_to_lower(opts.cols);
+    if (opts.val) mathi_string_to_lower(opts.val);
+    if (opts.compute) mathi_string_to_lower(opts.compute);
+    if (opts.style) mathi_string_to_lower(opts.style);
+
+    // Validate required
+    if ((!opts.file && !opts.data) || !opts.rows || !opts.cols || !opts.val)
+    {
+        out_printf("Missing required options: file (or data), rows, cols, val\n");
+        goto cleanup;
+    }
+    if (opts.file && opts.data)
+    {
+        out_printf("Error: use either file or data, not both\n");
+        goto cleanup;
+    }
+    if (opts.file && !mathi_file_exists(opts.file))
+    {
+        out_printf("Error: file not found -> %s\n", opts.file);
+        goto cleanup;
+    }
+
+    draw_pivot(&opts);
+
+cleanup:
+    free(opts.file);
+    free(opts.data);
+    free(opts.rows);
+    free(opts.cols);
+    free(opts.val);
+    free(opts.compute);
+    free(opts.where);
+    free(opts.style);
+    free(opts.title);
+}
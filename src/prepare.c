@@ -0,0 +1,198 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "../headers/mathigraphs.h"
+
+// Prepared queries by name, shared by server workers like datasets are
+static Prepared *prepared;
+static pthread_mutex_t prepared_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Helper: release a prepared query
+static void prepared_free(Prepared *p)
+{
+    for (int i = 0; i < p->ncols; i++) free(p->header[i]);
+    free(p->header);
+    bar_plan_free(&p->plan);
+    free_bar_options(&p->opts);
+    free(p->name);
+    free(p);
+}
+
+// Helper: drop a reference; the last one frees a replaced query
+static void prepared_release(Prepared *p)
+{
+    pthread_mutex_lock(&prepared_lock);
+    int last = --p->refs == 0;
+    pthread_mutex_unlock(&prepared_lock);
+    if (last) prepared_free(p);
+}
+
+// Helper: split "NAME rest" after the command word; returns the name (malloc'd)
+// and points *rest at what follows it
+static char *command_name(const char *command, size_t skip, const char **rest)
+{
+    const char *p = command + skip;
+    while (*p == ' ' || *p == '\t') p++;
+    const char *start = p;
+    while (*p && *p != ' ' && *p != '\t') p++;
+    if (p == start) return NULL;
+    *rest = p;
+    return strndup(start, p - start);
+}
+
+// Helper: read the header of a file query and resolve the plan against it
+static int prepare_file(Prepared *p)
+{
+    if (csv_fingerprint(p->opts.file, &p->fp) != 0)
+    {
+        out_printf("Error: file not found -> %s\n", p->opts.file);
+        return -1;
+    }
+
+    CsvReader csv;
+    int rc = csv_open(&csv, p->opts.file);
+    if (rc != 0)
+    {
+        csv_open_error(rc, p->opts.file);
+        return -1;
+    }
+    p->header = calloc(csv.ncols, sizeof(char *));
+    if (!p->header)
+    {
+        out_printf("Error: out of memory\n");
+        csv_close(&csv);
+        return -1;
+    }
+    for (int i = 0; i < csv.ncols; i++) p->header[i] = strdup(csv.header[i]);
+    p->ncols = csv.ncols;
+    csv_close(&csv);
+    return bar_plan(&p->opts, p->header, p->ncols, &p->plan);
+}
+
+// Display prepare command: prepare NAME bar [options]
+void display_prepare(char *command)
+{
+    const char *rest;
+    char *name = command_name(command, strlen("prepare"), &rest);
+    while (rest && (*rest == ' ' || *rest == '\t')) rest++;
+    if (!name || strncmp(rest, "bar", 3) != 0 || (rest[3] != ' ' && rest[3] != '\0'))
+    {
+        out_printf("Usage: prepare NAME bar [options] (only bar queries can be prepared)\n");
+        free(name);
+        return;
+    }
+
+    Prepared *p = calloc(1, sizeof(Prepared));
+    if (!p)
+    {
+        out_printf("Error: out of memory\n");
+        free(name);
+        return;
+    }
+    p->name = name;
+    bar_options(rest, &p->opts);
+
+    // datasets can be reloaded with other columns, and a join reads two
+    // headers, so their plan is made per run
+    if (bar_validate(&p->opts) != 0 || (p->opts.file && !p->opts.join && prepare_file(p) != 0))
+    {
+        prepared_free(p);
+        return;
+    }
+
+    // preparing an existing name replaces it
+    pthread_mutex_lock(&prepared_lock);
+    Prepared *old = NULL;
+    for (Prepared **pp = &prepared; *pp; pp = &(*pp)->next)
+    {
+        if (strcmp((*pp)->name, name) == 0)
+        {
+            old = *pp;
+            *pp = old->next;
+            break;
+        }
+    }
+    p->refs = 1;
+    p->next = prepared;
+    prepared = p;
+    pthread_mutex_unlock(&prepared_lock);
+    if (old) prepared_release(old);
+
+    out_printf("Prepared '%s'\n", name);
+}
+
+// Display run command: run NAME [option overrides]. Options given here
+// replace the prepared ones for this run only; the columns are still looked
+// up in the cached header unless the file has changed since prepare.
+void display_run(char *command)
+{
+    const char *rest;
+    char *name = command_name(command, strlen("run"), &rest);
+    if (!name)
+    {
+        out_printf("Usage: run NAME [options]\n");
+        return;
+    }
+
+    pthread_mutex_lock(&prepared_lock);
+    Prepared *p = prepared;
+    while (p && strcmp(p->name, name) != 0) p = p->next;
+    if (p) p->refs++;
+    pthread_mutex_unlock(&prepared_lock);
+    if (!p)
+    {
+        out_printf("Error: no prepared query -> %s\n", name);
+        free(name);
+        return;
+    }
+    free(name);
+
+    BarOptions over, opts = p->opts;
+    bar_options(rest, &over);
+    if (over.file || over.data)
+    {
+        opts.file = over.file;
+        opts.data = over.data;
+    }
+    if (over.x) opts.x = over.x;
+    if (over.y) opts.y = over.y;
+    if (over.title) opts.title = over.title;
+    if (over.compute) opts.compute = over.compute;
+    if (over.sort) opts.sort = over.sort;
+    if (over.bucket) opts.bucket = over.bucket;
+    if (over.profile) opts.profile = over.profile;
+    if (over.format) opts.format = over.format;
+    if (over.where) opts.where = over.where;
+    if (over.mem_limit) opts.mem_limit = over.mem_limit;
+    if (over.presorted) opts.presorted = over.presorted;
+    if (over.sample) opts.sample = over.sample;
+    if (over.sample_rows) opts.sample_rows = over.sample_rows;
+    if (over.progress) opts.progress = over.progress;
+    if (over.join) opts.join = over.join;
+    if (over.on) opts.on = over.on;
+    if (over.window) opts.window = over.window;
+    if (over.cube) opts.cube = over.cube;
+
+    int replanned = over.file || over.data || over.x || over.y || over.bucket || over.where || over.mem_limit ||
+                    over.presorted || over.sample || over.sample_rows || over.join || over.on ||
+                    over.window;
+    CsvFingerprint now;
+    int sameFile = !over.file && !over.data && !opts.join && p->opts.file && csv_fingerprint(p->opts.file, &now) == 0 &&
+                   csv_same_file(&now, &p->fp);
+
+    if ((over.file || over.join || over.on) && bar_validate(&opts) != 0) goto cleanup;
+    if (sameFile && !replanned) run_bar(&opts, &p->plan);
+    else if (sameFile)
+    {
+        // new columns or filter, still resolved against the cached header
+        BarPlan plan;
+        if (bar_plan(&opts, p->header, p->ncols, &plan) == 0) run_bar(&opts, &plan);
+        bar_plan_free(&plan);
+    }
+    else run_bar(&opts, NULL); // a dataset, another file, or the file changed
+
+cleanup:
+    free_bar_options(&over);
+    prepared_release(p);
+}
@@ -0,0 +1,56 @@
+#include <stdio.h>
+#include <unistd.h>
+#include "../headers/mathigraphs.h"
+
+// progress= as given, or by default only when output goes to a terminal.
+// Captured streams (server mode) have no descriptor and never get frames;
+// pipes get the final result alone unless progress='1'.
+int progress_wanted(const char *option)
+{
+    int fd = fileno(output_stream());
+    if (fd < 0) return 0;
+    if (option) return option_enabled(option);
+    return isatty(fd);
+}
+
+// Start timing a scan; nothing is drawn until the first interval passes,
+// so short queries look exactly as before
+void progress_start(Progress *p)
+{
+    p->start = p->last = stats_wall_ns();
+    p->lastBytes = 0;
+    p->ticks = 0;
+    p->lines = 0;
+}
+
+// Called once per row: true when a new frame is due. The clock is only
+// read every PROGRESS_CHECK_ROWS rows.
+int progress_due(Progress *p, long bytes)
+{
+    if (++p->ticks % PROGRESS_CHECK_ROWS != 0) return 0;
+    long long now = stats_wall_ns();
+    if (now - p->last < PROGRESS_INTERVAL_NS && bytes - p->lastBytes < PROGRESS_BYTES) return 0;
+    p->last = now;
+    p->lastBytes = bytes;
+    return 1;
+}
+
+// Move back over the frame on screen and clear it
+void progress_erase(Progress *p)
+{
+    if (p->lines > 0) out_printf("\033[%dA\033[J", p->lines);
+    p->lines = 0;
+    fflush(output_stream());
+}
+
+// Close a frame with how far the scan is (done from 0 to 1, negative when
+// unknown) and how fast it reads rows
+void progress_status(Progress *p, double done, long rows)
+{
+    double secs = (stats_wall_ns() - p->start) / 1e9;
+    if (done >= 0) out_printf("-- %.0f%% scanned, ", done * 100);
+    else out_printf("-- ");
+    out_printf("%ld rows, %.0f rows/s, %.1f s --\n", rows, secs > 0 ? rows / secs : 0, secs);
+    p->lines++;
+    fflush(output_stream());
+}
@@ -0,0 +1,68 @@
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "../headers/mathigraphs.h"
+
+// Seed a generator from the clock and the process, different on every query
+void sample_seed(SampleRng *rng)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    rng->state = (unsigned long long)ts.tv_nsec * 0x9E3779B97F4A7C15ULL ^ (unsigned long long)ts.tv_sec ^
+                 ((unsigned long long)getpid() << 32) ^ (unsigned long long)(size_t)rng;
+    if (rng->state == 0) rng->state = 1;
+}
+
+// Uniform double in (0, 1) from xorshift64*
+double sample_uniform(SampleRng *rng)
+{
+    unsigned long long x = rng->state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    rng->state = x;
+    return ((x * 0x2545F4914F6CDD1DULL >> 11) + 0.5) / 9007199254740992.0;
+}
+
+// Items to pass over before the next one kept, when each item is kept with
+// chance p: a geometric draw, so unkept items cost no random numbers
+long sample_gap(SampleRng *rng, double p)
+{
+    if (p >= 1) return 0;
+    double g = floor(log(sample_uniform(rng)) / log1p(-p));
+    return g > 1e15 ? (long)1e15 : (long)g;
+}
+
+// Start an empty reservoir of k slots
+void reservoir_init(Reservoir *r, long k)
+{
+    r->k = k;
+    r->seen = 0;
+    r->next = k;
+    r->w = 1;
+}
+
+// Offer the next stream item: the slot it goes to, or -1 when it is not kept.
+// Only every kept item draws random numbers, so a caller can skip the
+// unkept ones without parsing them.
+long reservoir_slot(Reservoir *r, SampleRng *rng)
+{
+    long i = r->seen++;
+    if (i < r->k)
+    {
+        if (i == r->k - 1)
+        {
+            r->w = exp(log(sample_uniform(rng)) / r->k);
+            r->next = r->k + (long)floor(log(sample_uniform(rng)) / log1p(-r->w));
+        }
+        return i;
+    }
+    if (i < r->next) return -1;
+
+    long slot = (long)(sample_uniform(rng) * r->k);
+    if (slot >= r->k) slot = r->k - 1;
+    r->w *= exp(log(sample_uniform(rng)) / r->k);
+    r->next = i + 1 + (long)floor(log(sample_uniform(rng)) / log1p(-r->w));
+    return slot;
+}
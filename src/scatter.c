@@ -0,0 +1,272 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../headers/mathigraphs.h"
+
+#define LABEL_WIDTH 12
+#define DEFAULT_HEIGHT 20
+
+static const char SHADES[] = " .:-=+*#%@";
+
+// Helper: read an optional numeric bound, 0 if present but invalid
+static int bound_option(const char *value, const char *name, double *out, int *have)
+{
+    *have = 0;
+    if (!value) return 1;
+    if (!csv_number(value, out) || !isfinite(*out))
+    {
+        out_printf("Error: %s is not a number -> %s\n", name, value);
+        return 0;
+    }
+    *have = 1;
+    return 1;
+}
+
+// Helper: read the point of a row, 0 when a coordinate is missing, not a
+// number, or nan or inf (those have no cell)
+static int read_point(const CsvReader *csv, int nf, int colX, int colY, double *x, double *y)
+{
+    if (colX >= nf || colY >= nf) return 0;
+    if (!csv_number(csv->fields[colX], x) || !csv_number(csv->fields[colY], y)) return 0;
+    return isfinite(*x) && isfinite(*y);
+}
+
+// Helper: print one braille cell (U+2800 block) as UTF-8
+static void put_braille(unsigned bits)
+{
+    out_putchar(0xE2);
+    out_putchar(0xA0 | (bits >> 6));
+    out_putchar(0x80 | (bits & 0x3F));
+}
+
+// Render the count grid, gw x gh bins shown in w x h cells
+static void render_scatter(const ScatterOptions *opts, const long *grid, int gw, int w, int h, int braille,
+                           double minX, double maxX, double minY, double maxY)
+{
+    // braille dot bits for a 2x4 cell, indexed [row][col]
+    static const unsigned DOTS[4][2] = {{0x01, 0x08}, {0x02, 0x10}, {0x04, 0x20}, {0x40, 0x80}};
+
+    long maxCount = 0;
+    for (long i = 0; i < (long)gw * (braille ? h * 4 : h); i++)
+        if (grid[i] > maxCount) maxCount = grid[i];
+
+    if (opts->title) out_printf("\n%s\n\n", opts->title);
+    for (int r = 0; r < h; r++)
+    {
+        if (r == 0) out_printf("%*.6g |", LABEL_WIDTH - 2, maxY);
+        else if (r == h - 1) out_printf("%*.6g |", LABEL_WIDTH - 2, minY);
+        else out_printf("%*s |", LABEL_WIDTH - 2, "");
+
+        for (int c = 0; c < w; c++)
+        {
+            if (braille)
+            {
+                unsigned bits = 0;
+                for (int dr = 0; dr < 4; dr++)
+                    for (int dc = 0; dc < 2; dc++)
+                        if (grid[(long)(r * 4 + dr) * gw + c * 2 + dc] > 0) bits |= DOTS[dr][dc];
+                if (bits) put_braille(bits);
+                else out_putchar(' ');
+            }
+            else
+            {
+                long n = grid[(long)r * gw + c];
+                int level = 0;
+                if (n > 0)
+                {
+                    // square-root scale keeps sparse cells visible next to dense ones
+                    level = 1 + (int)(sqrt((double)n / maxCount) * (sizeof(SHADES) - 3));
+                }
+                out_putchar(SHADES[level]);
+            }
+        }
+        out_printf("\n");
+    }
+    out_printf("%*s +", LABEL_WIDTH - 2, "");
+    for (int c = 0; c < w; c++) out_putchar('-');
+    out_printf("\n%*s  %-*.6g%*.6g\n\n", LABEL_WIDTH - 2, "", w / 2, minX, w - w / 2, maxX);
+}
+
+// Draw scatter plot: points are binned into a fixed grid during the scan
+void draw_scatter(const ScatterOptions *opts)
+{
+    int cols, rows;
+    term_size(&cols, &rows);
+    int w = term_option(opts->width, cols - LABEL_WIDTH - 1, 10, 1000);
+    int h = term_option(opts->height, DEFAULT_HEIGHT, 4, 200);
+
+    int braille = 0;
+    if (opts->style && strcmp(opts->style, "braille") == 0) braille = 1;
+    else if (opts->style && strcmp(opts->style, "shade") != 0)
+    {
+        out_printf("Warning: unknown style '%s'. Using shade.\n", opts->style);
+    }
+
+    double minX = 0, maxX = 0, minY = 0, maxY = 0;
+    int haveMinX, haveMaxX, haveMinY, haveMaxY;
+    if (!bound_option(opts->xmin, "xmin", &minX, &haveMinX) || !bound_option(opts->xmax, "xmax", &maxX, &haveMaxX) ||
+        !bound_option(opts->ymin, "ymin", &minY, &haveMinY) || !bound_option(opts->ymax, "ymax", &maxY, &haveMaxY))
+        return;
+
+    CsvReader csv;
+    int rc = csv_open(&csv, opts->file);
+    if (rc != 0)
+    {
+        csv_open_error(rc, opts->file);
+        return;
+    }
+
+    int colX = csv_find_column(&csv, opts->x);
+    int colY = csv_find_column(&csv, opts->y);
+    if (colX == -1 || colY == -1)
+    {
+        out_printf("Error: columns not found -> x:%s y:%s\n", opts->x, opts->y);
+        csv_close(&csv);
+        return;
+    }
+
+    int nf;
+    double x, y;
+
+    // Range pass, skipped when all four bounds are given
+    if (!haveMinX || !haveMaxX || !haveMinY || !haveMaxY)
+    {
+        double loX = 0, hiX = 0, loY = 0, hiY = 0;
+        long seen = 0;
+        while ((nf = csv_next(&csv)) >= 0)
+        {
+            if (!read_point(&csv, nf, colX, colY, &x, &y)) continue;
+            if (seen == 0) { loX = hiX = x; loY = hiY = y; }
+            if (x < loX) loX = x;
+            if (x > hiX) hiX = x;
+            if (y < loY) loY = y;
+            if (y > hiY) hiY = y;
+            seen++;
+        }
+        if (cancel_requested())
+        {
+            csv_close(&csv);
+            return;
+        }
+        if (seen == 0)
+        {
+            out_printf("No rows to plot.\n");
+            csv_close(&csv);
+            return;
+        }
+        if (!haveMinX) minX = loX;
+        if (!haveMaxX) maxX = hiX;
+        if (!haveMinY) minY = loY;
+        if (!haveMaxY) maxY = hiY;
+        csv_rewind(&csv);
+    }
+
+    if (maxX < minX || maxY < minY)
+    {
+        out_printf("Error: max bounds must not be below min bounds\n");
+        csv_close(&csv);
+        return;
+    }
+
+    // Binning pass: O(cells) counters, braille has 2x4 dots per cell
+    int gw = braille ? w * 2 : w;
+    int gh = braille ? h * 4 : h;
+    long *grid = calloc((size_t)gw * gh, sizeof(long));
+    if (!grid)
+    {
+        out_printf("Error: out of memory\n");
+        csv_close(&csv);
+        return;
+    }
+
+    double spanX = maxX > minX ? maxX - minX : 1;
+    double spanY = maxY > minY ? maxY - minY : 1;
+    double sx = 0, sy = 0, sxx = 0, syy = 0, sxy = 0;
+    long n = 0, outside = 0;
+    while ((nf = csv_next(&csv)) >= 0)
+    {
+        if (!read_point(&csv, nf, colX, colY, &x, &y)) continue;
+        if (x < minX || x > maxX || y < minY || y > maxY) { outside++; continue; }
+
+        int c = (int)((x - minX) / spanX * gw);
+        int r = (int)((y - minY) / spanY * gh);
+        if (c >= gw) c = gw - 1;
+        if (r >= gh) r = gh - 1;
+        grid[(long)(gh - 1 - r) * gw + c]++;
+
+        sx += x; sy += y; sxx += x * x; syy += y * y; sxy += x * y;
+        n++;
+    }
+    csv_close(&csv);
+    if (cancel_requested())
+    {
+        free(grid);
+        return;
+    }
+
+    if (n == 0)
+    {
+        out_printf("No rows to plot.\n");
+        free(grid);
+        return;
+    }
+
+    render_scatter(opts, grid, gw, w, h, braille, minX, maxX, minY, maxY);
+
+    double vx = n * sxx - sx * sx, vy = n * syy - sy * sy;
+    if (vx > 0 && vy > 0) out_printf("(%ld points, pearson r = %.4f)\n", n, (n * sxy - sx * sy) / sqrt(vx * vy));
+    else out_printf("(%ld points)\n", n);
+    if (outside > 0) out_printf("(%ld points outside the bounds skipped)\n", outside);
+
+    free(grid);
+}
+
+// Display scatter command
+void display_scatter(char *command)
+{
+    ScatterOptions opts = {0}; // null all members
+    opts.file = get_option_value(command, "file=");
+    opts.x = get_option_value(command, "x=");
+    opts.y = get_option_value(command, "y=");
+    opts.title = get_option_value(command, "title=");
+    opts.width = get_option_value(command, "width=");
+    opts.height = get_option_value(command, "height=");
+    opts.style = get_option_value(command, "style=");
+    opts.xmin = get_option_value(command, "xmin=");
+    opts.xmax = get_option_value(command, "xmax=");
+    opts.ymin = get_option_value(command, "ymin=");
+    opts.ymax = get_option_value(command, "ymax=");
+
+    if (opts.x) mathi_string_to_lower(opts.x);
+    if (opts.y) mathi_string_to_lower(opts.y);
+    if (opts.style) mathi_string_to_lower(opts.style);
+
+    // Validate required
+    if (!opts.file || !opts.x || !opts.y)
+    {
+        out_printf("Missing required options: file, x, y\n");
+        goto cleanup;
+    }
+
+    if (!mathi_file_exists(opts.file))
+    {
+        out_printf("Error: file not found -> %s\n", opts.file);
+        goto cleanup;
+    }
+
+    draw_scatter(&opts);
+
+cleanup:
+    free(opts.file);
+    free(opts.x);
+    free(opts.y);
+    free(opts.title);
+    free(opts.width);
+    free(opts.height);
+    free(opts.style);
+    free(opts.xmin);
+    free(opts.xmax);
+    free(opts.ymin);
+    free(opts.ymax);
+}
@@ -0,0 +1,224 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "../headers/mathigraphs.h"
+
+// Column types of files sniffed so far, with the fingerprint they were
+// taken at; an edited file is sniffed again. Shared by server workers.
+typedef struct SchemaEntry {
+    struct SchemaEntry *next;
+    char *file;
+    CsvFingerprint fp;
+    int ncols;
+    SchemaType *types;
+} SchemaEntry;
+
+static SchemaEntry *cache;
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// A plain decimal integer: optional '-', no leading zeros (so codes such as
+// '007' stay text), at most 18 digits. Returns 1 on success.
+int schema_int(const char *s, long long *out)
+{
+    const char *p = s;
+    int neg = *p == '-';
+    if (neg) p++;
+    if (*p < '0' || *p > '9' || (*p == '0' && p[1] != '\0')) return 0;
+
+    long long v = 0;
+    int digits = 0;
+    for (; *p >= '0' && *p <= '9'; p++)
+    {
+        if (++digits > 18) return 0;
+        v = v * 10 + (*p - '0');
+    }
+    if (*p != '\0') return 0;
+    *out = neg ? -v : v;
+    return 1;
+}
+
+// A number as csv_number reads it, except that a leading zero followed by
+// another digit ('02139', '-007.5') marks a code, which stays text like it
+// does for schema_int. Returns 1 on success.
+int schema_double(const char *s, double *out)
+{
+    const char *p = s;
+    if (*p == '-' || *p == '+') p++;
+    if (p[0] == '0' && p[1] >= '0' && p[1] <= '9') return 0;
+    return csv_number(s, out);
+}
+
+// A date written YYYY-MM-DD, as days since 1970-01-01. Returns 1 on success.
+int schema_date(const char *s, int32_t *days)
+{
+    long long t;
+    if (strlen(s) != 10 || s[4] != '-' || !ts_parse(s, &t)) return 0;
+    *days = (int32_t)(t / 86400);
+    return 1;
+}
+
+// Type of one cell, SCHEMA_EMPTY for an empty one
+SchemaType schema_cell(const char *s)
+{
+    long long i;
+    int32_t d;
+    double x;
+    if (!*s) return SCHEMA_EMPTY;
+    if (schema_int(s, &i)) return SCHEMA_INT64;
+    if (schema_double(s, &x)) return SCHEMA_DOUBLE;
+    if (schema_date(s, &d)) return SCHEMA_DATE;
+    return SCHEMA_TEXT;
+}
+
+// Type that holds values of both types: integers widen to doubles, anything
+// else mixed is text
+SchemaType schema_merge(SchemaType a, SchemaType b)
+{
+    if (a == SCHEMA_EMPTY) return b;
+    if (b == SCHEMA_EMPTY || a == b) return a;
+    if ((a == SCHEMA_INT64 && b == SCHEMA_DOUBLE) || (a == SCHEMA_DOUBLE && b == SCHEMA_INT64)) return SCHEMA_DOUBLE;
+    return SCHEMA_TEXT;
+}
+
+// Name of a type as the schema command prints it
+const char *schema_type_name(SchemaType t)
+{
+    switch (t)
+    {
+        case SCHEMA_INT64: return "int64";
+        case SCHEMA_DOUBLE: return "double";
+        case SCHEMA_DATE: return "date";
+        case SCHEMA_EMPTY: return "empty";
+        default: return "text";
+    }
+}
+
+// Parse a cell of a column of type t as a number: integer columns take the
+// integer parser first, and everything falls back to csv_number, so a cell
+// the sniffed rows did not foresee still reads correctly
+int schema_number(SchemaType t, const char *s, double *out)
+{
+    long long v;
+    if (t == SCHEMA_INT64 && schema_int(s, &v))
+    {
+        *out = (double)v;
+        return 1;
+    }
+    return csv_number(s, out);
+}
+
+// Helper: infer the types of the first SCHEMA_SAMPLE_ROWS rows of a file
+static int schema_sniff(const char *file, SchemaType *types, int ncols)
+{
+    CsvReader csv;
+    if (csv_open(&csv, file) != 0) return -1;
+    if (csv.ncols != ncols)
+    {
+        csv_close(&csv);
+        return -1;
+    }
+    for (int c = 0; c < ncols; c++) types[c] = SCHEMA_EMPTY;
+
+    int nf;
+    while (csv.rows < SCHEMA_SAMPLE_ROWS && (nf = csv_next(&csv)) >= 0)
+        for (int c = 0; c < ncols && c < nf; c++) types[c] = schema_merge(types[c], schema_cell(csv.fields[c]));
+    csv_close(&csv);
+    return 0;
+}
+
+// Helper: the cache entry for a file, lock held
+static SchemaEntry *cache_find(const char *file)
+{
+    SchemaEntry *e = cache;
+    while (e && strcmp(e->file, file) != 0) e = e->next;
+    return e;
+}
+
+// Helper: store types for a file as of fingerprint fp, lock held
+static void cache_store(const char *file, const CsvFingerprint *fp, const SchemaType *types, int ncols)
+{
+    SchemaEntry *e = cache_find(file);
+    if (!e)
+    {
+        e = calloc(1, sizeof(SchemaEntry));
+        if (!e) return;
+        e->file = strdup(file);
+        if (!e->file) { free(e); return; }
+        e->next = cache;
+        cache = e;
+    }
+    if (e->ncols != ncols)
+    {
+        SchemaType *nt = realloc(e->types, ncols * sizeof(SchemaType));
+        if (!nt) { e->ncols = 0; return; }
+        e->types = nt;
+        e->ncols = ncols;
+    }
+    memcpy(e->types, types, ncols * sizeof(SchemaType));
+    e->fp = *fp;
+}
+
+// Column types of a file with ncols columns, from the cache while the file
+// is unchanged, else sniffed from its first rows. Returns 0 on success.
+int schema_get(const char *file, SchemaType *types, int ncols)
+{
+    CsvFingerprint fp;
+    if (csv_fingerprint(file, &fp) != 0) return -1;
+
+    pthread_mutex_lock(&cache_lock);
+    SchemaEntry *e = cache_find(file);
+    int hit = e && e->ncols == ncols && csv_same_file(&e->fp, &fp);
+    if (hit) memcpy(types, e->types, ncols * sizeof(SchemaType));
+    pthread_mutex_unlock(&cache_lock);
+    if (hit) return 0;
+
+    if (schema_sniff(file, types, ncols) != 0) return -1;
+    pthread_mutex_lock(&cache_lock);
+    cache_store(file, &fp, types, ncols);
+    pthread_mutex_unlock(&cache_lock);
+    return 0;
+}
+
+// Replace the cached types of a file once a full read has found rows the
+// sniffed ones did not foresee
+void schema_update(const char *file, const SchemaType *types, int ncols)
+{
+    CsvFingerprint fp;
+    if (csv_fingerprint(file, &fp) != 0) return;
+    pthread_mutex_lock(&cache_lock);
+    cache_store(file, &fp, types, ncols);
+    pthread_mutex_unlock(&cache_lock);
+}
+
+// Display schema command: the inferred type of every column of a file
+void display_schema(char *command)
+{
+    char *file = get_option_value(command, "file=");
+    if (!file)
+    {
+        out_printf("Missing required options: file\n");
+        return;
+    }
+
+    CsvReader csv;
+    int rc = csv_open(&csv, file);
+    if (rc != 0)
+    {
+        csv_open_error(rc, file);
+        free(file);
+        return;
+    }
+
+    SchemaType *types = malloc(csv.ncols * sizeof(SchemaType));
+    if (!types) out_printf("Error: out of memory\n");
+    else if (schema_get(file, types, csv.ncols) != 0) out_printf("Error: could not read file: %s\n", file);
+    else
+    {
+        out_printf("%-24s %s\n", "column", "type");
+        for (int c = 0; c < csv.ncols; c++) out_printf("%-24s %s\n", csv.header[c], schema_type_name(types[c]));
+    }
+    free(types);
+    csv_close(&csv);
+    free(file);
+}
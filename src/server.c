@@ -0,0 +1,558 @@
+#define _GNU_SOURCE // accept4
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include "../headers/mathigraphs.h"
+
+#define SERVER_BACKLOG 128
+#define SERVER_EVENTS 64
+#define SERVER_READ_CHUNK 4096
+#define SERVER_MAX_LINE 65536
+#define SERVER_MAX_QUEUED 64
+#define SERVER_MAX_WORKERS 64
+
+// Job priorities, most urgent first
+enum { PRIORITY_HIGH, PRIORITY_NORMAL, PRIORITY_LOW };
+
+typedef struct Job {
+    struct Job *next;
+    char *line;
+    int priority;
+} Job;
+
+typedef struct Client {
+    struct Client *prev;
+    struct Client *next;
+    int fd;
+    char *in;          // bytes received, not yet a full line
+    size_t inLen;
+    size_t inCap;
+    char *out;         // responses not yet sent
+    size_t outLen;
+    size_t outCap;
+    size_t outPos;
+    int closing;       // close once out is flushed
+    unsigned events;   // epoll interest currently registered
+
+    // shared with the workers, guarded by Server.lock
+    Job *head;         // commands waiting, run one at a time in order
+    Job *tail;
+    int queued;
+    int running;       // a worker holds this client's head command
+    int dead;          // connection gone, free when the worker is done
+    long ticket;       // when the client became ready, for round robin
+    char *result;      // output of the finished command
+    size_t resultLen;
+    int quit;
+    int memstats;      // memstats on for this session
+    struct Client *doneNext;
+} Client;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t work;
+    Client *clients;   // every connection, for the scheduler to scan
+    Client *done;      // finished commands for the I/O thread
+    long tickets;
+    int workers;
+    int busy;
+    int wakefd;        // eventfd the workers poke when something is done
+} Server;
+
+static Server server;
+static char wake_tag; // epoll tag of the eventfd
+
+// Helper: append bytes to a growable buffer, -1 when out of memory
+static int buffer_append(char **buf, size_t *len, size_t *cap, const char *data, size_t n)
+{
+    if (*len + n > *cap)
+    {
+        size_t ncap = *cap ? *cap : 1024;
+        while (ncap < *len + n) ncap *= 2;
+        char *nb = realloc(*buf, ncap);
+        if (!nb) return -1;
+        *buf = nb;
+        *cap = ncap;
+    }
+    memcpy(*buf + *len, data, n);
+    *len += n;
+    return 0;
+}
+
+// Helper: split "host:port" or "port", default host is loopback
+static int parse_address(const char *address, struct sockaddr_in *sa)
+{
+    char host[64] = "127.0.0.1";
+    const char *port = address;
+    const char *colon = strrchr(address, ':');
+    if (colon)
+    {
+        size_t n = colon - address;
+        if (n == 0 || n >= sizeof(host)) return -1;
+        memcpy(host, address, n);
+        host[n] = '\0';
+        port = colon + 1;
+    }
+
+    int p;
+    if (mathi_str_to_int(port, &p) != 0 || p < 1 || p > 65535) return -1;
+    memset(sa, 0, sizeof(*sa));
+    sa->sin_family = AF_INET;
+    sa->sin_port = htons((unsigned short)p);
+    return inet_pton(AF_INET, host, &sa->sin_addr) == 1 ? 0 : -1;
+}
+
+// Helper: priority of a command line. priority='high|normal|low' wins;
+// otherwise commands that read no file (help, memstats, ...) are high.
+// run may execute a prepared file query, so it is normal.
+static int job_priority(const char *line)
+{
+    int priority = strstr(line, "file=") || strncmp(line, "run", 3) == 0 ? PRIORITY_NORMAL : PRIORITY_HIGH;
+    char *value = get_option_value(line, "priority=");
+    if (value)
+    {
+        mathi_string_to_lower(value);
+        if (strcmp(value, "high") == 0) priority = PRIORITY_HIGH;
+        else if (strcmp(value, "normal") == 0) priority = PRIORITY_NORMAL;
+        else if (strcmp(value, "low") == 0) priority = PRIORITY_LOW;
+        free(value);
+    }
+    return priority;
+}
+
+// Helper: pick the next client to serve, lock held. The most urgent head
+// command wins and equal priorities go round robin by ticket. A client has
+// at most one command running, so one long scan holds at most one worker,
+// and the last free worker is kept for high-priority commands.
+static Client *pick_client(void)
+{
+    Client *best = NULL;
+    int reserve = server.workers > 1 && server.busy >= server.workers - 1;
+    for (Client *c = server.clients; c; c = c->next)
+    {
+        if (c->dead || c->running || !c->head) continue;
+        int p = c->head->priority;
+        if (reserve && p != PRIORITY_HIGH) continue;
+        if (!best || p < best->head->priority || (p == best->head->priority && c->ticket < best->ticket)) best = c;
+    }
+    return best;
+}
+
+// Helper: run one command of a client with this thread's output captured
+// and memory accounting set the way the client's session left it
+static char *run_captured(Client *c, char *line, size_t *len, int *quit)
+{
+    char *text = NULL;
+    *len = 0;
+    FILE *mem = open_memstream(&text, len);
+    if (!mem)
+    {
+        *quit = 0;
+        return NULL;
+    }
+    output_capture(mem);
+    mem_tracking(c->memstats);
+    *quit = run_command(line);
+    c->memstats = mem_tracking_enabled();
+    mem_tracking(0);
+    output_capture(NULL);
+    fclose(mem);
+    return text;
+}
+
+// Worker thread: take the next command, run it, hand the output back
+static void *worker_main(void *arg)
+{
+    (void)arg;
+    while (1)
+    {
+        pthread_mutex_lock(&server.lock);
+        Client *c;
+        while (!(c = pick_client())) pthread_cond_wait(&server.work, &server.lock);
+        Job *job = c->head;
+        c->head = job->next;
+        if (!c->head) c->tail = NULL;
+        c->queued--;
+        c->running = 1;
+        server.busy++;
+        pthread_mutex_unlock(&server.lock);
+
+        size_t len;
+        int quit;
+        char *text = run_captured(c, job->line, &len, &quit);
+        free(job->line);
+        free(job);
+
+        pthread_mutex_lock(&server.lock);
+        c->result = text;
+        c->resultLen = len;
+        c->quit = quit;
+        c->doneNext = server.done;
+        server.done = c;
+        server.busy--;
+        pthread_cond_broadcast(&server.work); // a reserved slot may be free again
+        pthread_mutex_unlock(&server.lock);
+
+        uint64_t one = 1;
+        if (write(server.wakefd, &one, sizeof(one)) < 0) { /* counter saturated: already awake */ }
+    }
+    return NULL;
+}
+
+// Helper: drop commands that have not started, lock held
+static void drop_jobs(Client *c)
+{
+    while (c->head)
+    {
+        Job *job = c->head;
+        c->head = job->next;
+        free(job->line);
+        free(job);
+    }
+    c->tail = NULL;
+    c->queued = 0;
+}
+
+// Helper: queue every complete line in the input buffer
+static int queue_lines(Client *c)
+{
+    size_t start = 0;
+    int added = 0;
+    pthread_mutex_lock(&server.lock);
+    while (!c->closing && c->queued < SERVER_MAX_QUEUED)
+    {
+        char *nl = memchr(c->in + start, '\n', c->inLen - start);
+        if (!nl) break;
+        *nl = '\0';
+        if (nl > c->in + start && nl[-1] == '\r') nl[-1] = '\0';
+
+        Job *job = malloc(sizeof(Job));
+        if (job) job->line = strdup(c->in + start);
+        if (!job || !job->line)
+        {
+            free(job);
+            pthread_mutex_unlock(&server.lock);
+            return -1;
+        }
+        job->next = NULL;
+        job->priority = job_priority(job->line);
+        if (!c->head && !c->running) c->ticket = ++server.tickets;
+        if (c->tail) c->tail->next = job;
+        else c->head = job;
+        c->tail = job;
+        c->queued++;
+        added = 1;
+        start = nl - c->in + 1;
+    }
+    if (added) pthread_cond_broadcast(&server.work);
+    pthread_mutex_unlock(&server.lock);
+
+    memmove(c->in, c->in + start, c->inLen - start);
+    c->inLen -= start;
+    if (c->inLen > SERVER_MAX_LINE && !memchr(c->in, '\n', c->inLen))
+    {
+        const char *msg = "ERR line too long\n";
+        buffer_append(&c->out, &c->outLen, &c->outCap, msg, strlen(msg));
+        c->closing = 1;
+    }
+    return 0;
+}
+
+// Helper: read whatever is available, 1 when the peer has closed its side
+static int client_read(Client *c)
+{
+    char chunk[SERVER_READ_CHUNK];
+    while (c->inLen <= SERVER_MAX_LINE * 2)
+    {
+        ssize_t n = recv(c->fd, chunk, sizeof(chunk), 0);
+        if (n > 0)
+        {
+            if (buffer_append(&c->in, &c->inLen, &c->inCap, chunk, n) != 0) return -1;
+            continue;
+        }
+        if (n == 0) return 1;
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+        return -1;
+    }
+    return 0; // enough buffered; the rest waits until the queue drains
+}
+
+// Helper: send queued output until the socket would block
+static int client_flush(Client *c)
+{
+    while (c->outPos < c->outLen)
+    {
+        ssize_t n = send(c->fd, c->out + c->outPos, c->outLen - c->outPos, MSG_NOSIGNAL);
+        if (n > 0) { c->outPos += n; continue; }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 0;
+        return -1;
+    }
+    c->outPos = c->outLen = 0;
+    return 0;
+}
+
+// Helper: release a client nobody refers to any more, lock held
+static void client_free(Client *c)
+{
+    if (c->prev) c->prev->next = c->next;
+    else server.clients = c->next;
+    if (c->next) c->next->prev = c->prev;
+    free(c->in);
+    free(c->out);
+    free(c->result);
+    free(c);
+}
+
+// Helper: close a connection; a running command keeps the client alive
+static void client_close(int ep, Client *c)
+{
+    epoll_ctl(ep, EPOLL_CTL_DEL, c->fd, NULL);
+    close(c->fd);
+    pthread_mutex_lock(&server.lock);
+    drop_jobs(c);
+    c->dead = 1;
+    if (!c->running) client_free(c);
+    pthread_mutex_unlock(&server.lock);
+}
+
+// Helper: flush output and set the epoll interest, 0 if the client was closed
+static int client_update(int ep, Client *c, int eof)
+{
+    if (client_flush(c) != 0) { client_close(ep, c); return 0; }
+
+    pthread_mutex_lock(&server.lock);
+    int idle = !c->running && !c->head;
+    int full = c->queued >= SERVER_MAX_QUEUED;
+    pthread_mutex_unlock(&server.lock);
+
+    int pending = c->outLen > 0;
+    if (eof) c->closing = 1; // half-closed: finish the queued commands, read no more
+    if (c->closing && idle && !pending) { client_close(ep, c); return 0; }
+
+    // read only while there is room to queue, write only while output is queued
+    unsigned want = (c->closing || full ? 0 : EPOLLIN | EPOLLRDHUP) | (pending ? EPOLLOUT : 0);
+    if (want != c->events)
+    {
+        struct epoll_event ev = {0};
+        ev.events = want;
+        ev.data.ptr = c;
+        epoll_ctl(ep, EPOLL_CTL_MOD, c->fd, &ev);
+        c->events = want;
+    }
+    return 1;
+}
+
+// Helper: accept every pending connection on the listening socket
+static void accept_clients(int ep, int lfd)
+{
+    while (1)
+    {
+        int fd = accept4(lfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            if (errno == EINTR) continue;
+            return; // EAGAIN, or out of descriptors until a client leaves
+        }
+
+        Client *c = calloc(1, sizeof(Client));
+        struct epoll_event ev = {0};
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.ptr = c;
+        if (!c || (c->fd = fd, c->events = ev.events, epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev) != 0))
+        {
+            free(c);
+            close(fd);
+            continue;
+        }
+
+        pthread_mutex_lock(&server.lock);
+        c->next = server.clients;
+        if (server.clients) server.clients->prev = c;
+        server.clients = c;
+        pthread_mutex_unlock(&server.lock);
+    }
+}
+
+// Helper: handle readiness on one client; the client may be closed on return
+static void client_event(int ep, Client *c, unsigned events)
+{
+    int eof = 0;
+    // both directions gone: nobody is left to read an answer
+    if (events & (EPOLLERR | EPOLLHUP)) { client_close(ep, c); return; }
+    if (events & (EPOLLIN | EPOLLRDHUP))
+    {
+        eof = client_read(c);
+        if (eof < 0 || queue_lines(c) != 0) { client_close(ep, c); return; }
+    }
+    client_update(ep, c, eof);
+}
+
+// Helper: move a finished command's output into the client's send buffer
+// as "OK <bytes>\n" and the bytes, lock held. -1 when out of memory.
+static int take_result(Client *c)
+{
+    char head[32];
+    int hn = snprintf(head, sizeof(head), "OK %zu\n", c->resultLen);
+    int rc = buffer_append(&c->out, &c->outLen, &c->outCap, head, hn);
+    if (rc == 0) rc = buffer_append(&c->out, &c->outLen, &c->outCap, c->result ? c->result : "", c->resultLen);
+    free(c->result);
+    c->result = NULL;
+    c->resultLen = 0;
+    return rc;
+}
+
+// Helper: queue the output of finished commands and schedule what follows
+static void collect_done(int ep)
+{
+    uint64_t count;
+    if (read(server.wakefd, &count, sizeof(count)) < 0) { /* spurious wakeup */ }
+
+    // Each result and list link is taken before running is cleared: from
+    // then on a worker may start the client's next command and reuse them.
+    // A client has one command running at a time, so at most one per worker
+    // is done.
+    Client *ready[SERVER_MAX_WORKERS];
+    int failed[SERVER_MAX_WORKERS];
+    int n = 0;
+    pthread_mutex_lock(&server.lock);
+    Client *done = server.done;
+    server.done = NULL;
+    while (done)
+    {
+        Client *c = done;
+        done = c->doneNext;
+        c->doneNext = NULL;
+        c->running = 0;
+        if (c->dead)
+        {
+            client_free(c);
+            continue;
+        }
+        if (c->quit)
+        {
+            drop_jobs(c);
+            c->closing = 1;
+        }
+        failed[n] = take_result(c) != 0;
+        if (c->head) c->ticket = ++server.tickets;
+        ready[n++] = c;
+    }
+    if (n > 0) pthread_cond_broadcast(&server.work);
+    pthread_mutex_unlock(&server.lock);
+
+    for (int i = 0; i < n; i++)
+    {
+        Client *c = ready[i];
+        if (failed[i]) { client_close(ep, c); continue; }
+
+        // lines held back while the queue was full
+        if (queue_lines(c) != 0) { client_close(ep, c); continue; }
+        client_update(ep, c, 0);
+    }
+}
+
+// Serve commands over TCP: one command per line, each answered with
+// "OK <bytes>\n" followed by exactly that many bytes of output. The I/O
+// thread multiplexes every client with epoll and never runs a command;
+// commands run on a fixed pool of worker threads.
+int serve_mathigraphs(const char *address, int workers)
+{
+    struct sockaddr_in sa;
+    if (parse_address(address, &sa) != 0)
+    {
+        printf("Error: invalid address -> %s (use port or host:port)\n", address);
+        return -1;
+    }
+    if (workers <= 0)
+    {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        workers = n > 1 ? (int)n : 2;
+    }
+    workers = mathi_clamp_int(workers, 1, SERVER_MAX_WORKERS);
+
+    int lfd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int one = 1;
+    if (lfd < 0 || setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) != 0 ||
+        bind(lfd, (struct sockaddr *)&sa, sizeof(sa)) != 0 || listen(lfd, SERVER_BACKLOG) != 0)
+    {
+        printf("Error: cannot listen on %s: %s\n", address, strerror(errno));
+        if (lfd >= 0) close(lfd);
+        return -1;
+    }
+
+    int ep = epoll_create1(EPOLL_CLOEXEC);
+    server.wakefd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    struct epoll_event ev = {0};
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL; // the listening socket
+    struct epoll_event wev = {0};
+    wev.events = EPOLLIN;
+    wev.data.ptr = &wake_tag;
+    if (ep < 0 || server.wakefd < 0 || epoll_ctl(ep, EPOLL_CTL_ADD, lfd, &ev) != 0 ||
+        epoll_ctl(ep, EPOLL_CTL_ADD, server.wakefd, &wev) != 0)
+    {
+        printf("Error: epoll: %s\n", strerror(errno));
+        if (ep >= 0) close(ep);
+        if (server.wakefd >= 0) close(server.wakefd);
+        close(lfd);
+        return -1;
+    }
+
+    pthread_mutex_init(&server.lock, NULL);
+    pthread_cond_init(&server.work, NULL);
+    server.workers = workers;
+    for (int i = 0; i < workers; i++)
+    {
+        pthread_t t;
+        if (pthread_create(&t, NULL, worker_main, NULL) != 0)
+        {
+            printf("Error: cannot start worker threads\n");
+            return -1;
+        }
+        pthread_detach(t);
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    char host[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &sa.sin_addr, host, sizeof(host));
+    printf("Serving on %s:%d with %d workers\n", host, ntohs(sa.sin_port), workers);
+    fflush(stdout);
+
+    struct epoll_event events[SERVER_EVENTS];
+    while (1)
+    {
+        int n = epoll_wait(ep, events, SERVER_EVENTS, -1);
+        if (n < 0)
+        {
+            if (errno == EINTR) continue;
+            printf("Error: epoll_wait: %s\n", strerror(errno));
+            break;
+        }
+
+        // finished commands last: collecting them may free a client that
+        // still has an event later in this batch
+        int wake = 0;
+        for (int i = 0; i < n; i++)
+        {
+            if (events[i].data.ptr == &wake_tag) wake = 1;
+            else if (!events[i].data.ptr) accept_clients(ep, lfd);
+            else client_event(ep, events[i].data.ptr, events[i].events);
+        }
+        if (wake) collect_done(ep);
+    }
+
+    close(ep);
+    close(lfd);
+    return -1;
+}
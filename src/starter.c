@@ -2,18 +2,20 @@
 
 void starter() 
 {
-	printf("\n");
-    printf("      Welcome to Mathi Graphs       \n");
-    printf("---\n\n");
+	out_printf("\n");
+    out_printf("      Welcome to Mathi Graphs       \n");
+    out_printf("---\n\n");
 
-    printf("Commands to get you started:\n");
-    printf("  help  - Show available commands\n");
-    printf("  exit  - Quit Mathi Graphs\n\n");
+    out_printf("Commands to get you started:\n");
+    out_printf("  help  - Show available commands\n");
+    out_printf("  memstats on|off - Report allocations and peak memory after each command\n");
+    out_printf("  Ctrl-C - Cancel a running command (twice at the prompt quits)\n");
+    out_printf("  exit  - Quit Mathi Graphs\n\n");
 
-    printf("About:\n");
-    printf("  Author: Macharia Nyamū\n");
-    printf("  GitHub: https://github.com/macharia-nyamu/\n");
-    printf("  Project: Mathi Graphs - a CLI tool for quick math visualizations\n\n");
+    out_printf("About:\n");
+    out_printf("  Author: Macharia Nyamū\n");
+    out_printf("  GitHub: https://github.com/macharia-nyamu/\n");
+    out_printf("  Project: Mathi Graphs - a CLI tool for quick math visualizations\n\n");
 
-    printf("---\n\n");
+    out_printf("---\n\n");
 }
\ No newline at end of file
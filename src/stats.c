@@ -0,0 +1,128 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "../headers/mathigraphs.h"
+
+static const char *STAGE_NAMES[STAGE_COUNT] = {"open", "header", "parse", "aggregate", "sort", "render"};
+
+// Monotonic wall clock in nanoseconds
+long long stats_wall_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// CPU time of the calling thread in nanoseconds
+long long stats_cpu_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Start a fresh set of counters
+void stats_init(QueryStats *s, int timing)
+{
+    memset(s, 0, sizeof(*s));
+    s->timing = timing;
+    s->stage = STAGE_NONE;
+}
+
+// Close the running stage and start the next one (STAGE_NONE to just stop)
+void stats_stage(QueryStats *s, QueryStage next)
+{
+    if (!s || !s->timing || s->stage == (int)next) return;
+
+    long long wall = stats_wall_ns(), cpu = stats_cpu_ns();
+    if (s->stage != STAGE_NONE)
+    {
+        s->wall_ns[s->stage] += wall - s->wall_start;
+        s->cpu_ns[s->stage] += cpu - s->cpu_start;
+    }
+    s->stage = next;
+    s->wall_start = wall;
+    s->cpu_start = cpu;
+}
+
+// Add rows and bytes handled by a stage
+void stats_count(QueryStats *s, QueryStage stage, long rows, long bytes)
+{
+    if (!s) return;
+    s->rows[stage] += rows;
+    s->bytes[stage] += bytes;
+}
+
+// Print the per-stage table
+void stats_report(const QueryStats *s)
+{
+    long long wall = 0, cpu = 0;
+    out_printf("%-10s %15s %15s %12s %14s\n", "stage", "wall_ns", "cpu_ns", "rows", "bytes");
+    for (int i = 0; i < STAGE_COUNT; i++)
+    {
+        out_printf("%-10s %15lld %15lld %12ld %14ld\n", STAGE_NAMES[i], s->wall_ns[i], s->cpu_ns[i], s->rows[i], s->bytes[i]);
+        wall += s->wall_ns[i];
+        cpu += s->cpu_ns[i];
+    }
+    out_printf("%-10s %15lld %15lld\n\n", "total", wall, cpu);
+}
+
+// Helper: set a numeric member of a JSON object
+static void set_number(MathiJSON *obj, const char *key, double value)
+{
+    mathison_set_value(obj, key, mathison_new_number(value));
+}
+
+// Counters and per-stage timings as a JSON object, for machine consumers
+MathiJSON *stats_json(const QueryStats *s)
+{
+    MathiJSON *obj = mathison_new_object();
+    MathiJSON *stages = mathison_new_object();
+    if (!obj || !stages)
+    {
+        if (obj) mathison_free(obj);
+        if (stages) mathison_free(stages);
+        return NULL;
+    }
+
+    long long wall = 0, cpu = 0;
+    for (int i = 0; i < STAGE_COUNT; i++)
+    {
+        MathiJSON *st = mathison_new_object();
+        if (!st) continue;
+        set_number(st, "wall_ns", (double)s->wall_ns[i]);
+        set_number(st, "cpu_ns", (double)s->cpu_ns[i]);
+        set_number(st, "rows", (double)s->rows[i]);
+        set_number(st, "bytes", (double)s->bytes[i]);
+        mathison_set_value(stages, STAGE_NAMES[i], st);
+        wall += s->wall_ns[i];
+        cpu += s->cpu_ns[i];
+    }
+
+    set_number(obj, "rows_scanned", (double)s->rows_scanned);
+    set_number(obj, "rows_rejected", (double)s->rows_rejected);
+    set_number(obj, "groups", (double)s->groups);
+    set_number(obj, "bytes_read", (double)s->bytes_read);
+    set_number(obj, "cache_hits", (double)s->cache_hits);
+    set_number(obj, "spill_bytes", (double)s->spill_bytes);
+    set_number(obj, "wall_ns", (double)wall);
+    set_number(obj, "cpu_ns", (double)cpu);
+    if (mem_tracking_enabled())
+    {
+        MemStats mem;
+        mem_snapshot(&mem);
+        set_number(obj, "mem_allocs", (double)mem.allocs);
+        set_number(obj, "mem_frees", (double)mem.frees);
+        set_number(obj, "mem_in_use", (double)mem.in_use);
+        set_number(obj, "mem_peak", (double)mem.peak);
+    }
+    mathison_set_value(obj, "stages", stages);
+    return obj;
+}
+
+// True for flag options such as profile='1', profile=on or profile=true
+int option_enabled(const char *value)
+{
+    return value && (strcmp(value, "1") == 0 || strcmp(value, "on") == 0 ||
+                     strcmp(value, "true") == 0 || strcmp(value, "yes") == 0);
+}
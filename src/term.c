@@ -0,0 +1,28 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include "../headers/mathigraphs.h"
+
+// Terminal size in characters, 80x24 when stdout is not a terminal (or is
+// a captured stream, as in server mode)
+void term_size(int *cols, int *rows)
+{
+    struct winsize ws;
+    int fd = fileno(output_stream());
+    *cols = 80;
+    *rows = 24;
+    if (fd >= 0 && isatty(fd) && ioctl(fd, TIOCGWINSZ, &ws) == 0 && ws.ws_col > 0)
+    {
+        *cols = ws.ws_col;
+        *rows = ws.ws_row;
+    }
+}
+
+// Parse a width/height style option, falling back when missing or out of range
+int term_option(const char *value, int fallback, int min, int max)
+{
+    int n;
+    if (!value || mathi_str_to_int(value, &n) != 0) n = fallback;
+    return mathi_clamp_int(n, min, max);
+}
@@ -0,0 +1,157 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "../headers/mathigraphs.h"
+
+// 1970-01-05 was a Monday; week buckets start there instead of on a Thursday
+#define WEEK_ORIGIN (4 * 86400LL)
+
+// Epoch values at or above this are taken as milliseconds (1e11 s is year 5138)
+#define EPOCH_MS_THRESHOLD 100000000000LL
+
+// Helper: read exactly n decimal digits
+static int read_digits(const char *s, int n, int *out)
+{
+    int v = 0;
+    for (int i = 0; i < n; i++)
+    {
+        if (s[i] < '0' || s[i] > '9') return 0;
+        v = v * 10 + (s[i] - '0');
+    }
+    *out = v;
+    return 1;
+}
+
+// Helper: days since 1970-01-01 for a proleptic Gregorian date (no libc, no timezone)
+static long long days_from_civil(int y, int m, int d)
+{
+    y -= m <= 2;
+    long long era = (y >= 0 ? y : y - 399) / 400;
+    long long yoe = y - era * 400;
+    long long doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    long long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+// Helper: plain integer epoch with optional fraction, seconds or milliseconds
+static int parse_epoch(const char *s, long long *out)
+{
+    const char *p = s;
+    int neg = 0;
+    if (*p == '-') { neg = 1; p++; }
+    if (*p < '0' || *p > '9') return 0;
+
+    long long v = 0;
+    while (*p >= '0' && *p <= '9')
+    {
+        if (v > 100000000000000000LL) return 0;
+        v = v * 10 + (*p++ - '0');
+    }
+    if (*p == '.')
+    {
+        p++;
+        while (*p >= '0' && *p <= '9') p++;
+    }
+    if (*p != '\0') return 0;
+
+    if (v >= EPOCH_MS_THRESHOLD) v /= 1000;
+    *out = neg ? -v : v;
+    return 1;
+}
+
+// Parse an ISO-8601 timestamp (YYYY-MM-DD[THH:MM[:SS[.f]]][Z|+HH:MM]) or an
+// epoch number into seconds since the epoch, UTC. Fixed offsets only, no
+// locale or strptime. Returns 1 on success.
+int ts_parse(const char *s, long long *out)
+{
+    int y, mo, d, h = 0, mi = 0, sec = 0;
+    if (!read_digits(s, 4, &y) || s[4] != '-') return parse_epoch(s, out);
+    if (!read_digits(s + 5, 2, &mo) || s[7] != '-' || !read_digits(s + 8, 2, &d)) return 0;
+    if (mo < 1 || mo > 12 || d < 1 || d > 31) return 0;
+
+    const char *p = s + 10;
+    if (*p == 'T' || *p == 't' || *p == ' ')
+    {
+        if (!read_digits(p + 1, 2, &h) || p[3] != ':' || !read_digits(p + 4, 2, &mi)) return 0;
+        p += 6;
+        if (*p == ':')
+        {
+            if (!read_digits(p + 1, 2, &sec)) return 0;
+            p += 3;
+            if (*p == '.' || *p == ',')
+            {
+                p++;
+                while (*p >= '0' && *p <= '9') p++;
+            }
+        }
+        if (h > 23 || mi > 59 || sec > 60) return 0;
+    }
+
+    long long offset = 0;
+    if (*p == 'Z' || *p == 'z') p++;
+    else if (*p == '+' || *p == '-')
+    {
+        int oh, om = 0;
+        int sign = *p == '-' ? -1 : 1;
+        if (!read_digits(p + 1, 2, &oh)) return 0;
+        p += 3;
+        if (*p == ':') p++;
+        if (read_digits(p, 2, &om)) p += 2;
+        offset = sign * (oh * 3600LL + om * 60LL);
+    }
+    if (*p != '\0') return 0;
+
+    *out = days_from_civil(y, mo, d) * 86400 + h * 3600LL + mi * 60LL + sec - offset;
+    return 1;
+}
+
+// Parse a bucket size such as '30s', '15m', '1h', '1d' or '1w' into seconds
+int ts_bucket_width(const char *spec, long long *seconds)
+{
+    long long n = 0;
+    const char *p = spec;
+    while (*p >= '0' && *p <= '9')
+    {
+        n = n * 10 + (*p++ - '0');
+        if (n > 100000000) return 0;
+    }
+    if (p == spec) n = 1; // bare unit, e.g. 'h'
+
+    long long unit;
+    if (strcmp(p, "s") == 0) unit = 1;
+    else if (strcmp(p, "m") == 0 || strcmp(p, "min") == 0) unit = 60;
+    else if (strcmp(p, "h") == 0) unit = 3600;
+    else if (strcmp(p, "d") == 0) unit = 86400;
+    else if (strcmp(p, "w") == 0) unit = 7 * 86400;
+    else return 0;
+
+    if (n <= 0) return 0;
+    *seconds = n * unit;
+    return 1;
+}
+
+// Bucket number of a timestamp: floor(t / width), also for times before 1970
+long long ts_bucket_index(long long t, long long width)
+{
+    if (width % (7 * 86400) == 0) t -= WEEK_ORIGIN;
+    long long q = t / width;
+    if (t % width != 0 && t < 0) q--;
+    return q;
+}
+
+// First second of a bucket number
+long long ts_bucket_start(long long index, long long width)
+{
+    return index * width + (width % (7 * 86400) == 0 ? WEEK_ORIGIN : 0);
+}
+
+// Format a bucket start with as much precision as the bucket width needs
+void ts_format(long long t, long long width, char *buf, size_t size)
+{
+    time_t tt = (time_t)t;
+    struct tm tm;
+    gmtime_r(&tt, &tm);
+    if (width % 86400 == 0) strftime(buf, size, "%Y-%m-%d", &tm);
+    else if (width % 60 == 0) strftime(buf, size, "%Y-%m-%d %H:%M", &tm);
+    else strftime(buf, size, "%Y-%m-%d %H:%M:%S", &tm);
+}
@@ -0,0 +1,363 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "../headers/mathigraphs.h"
+
+// Helper: skip blanks
+static const char *skip_blanks(const char *p)
+{
+    while (*p == ' ' || *p == '\t') p++;
+    return p;
+}
+
+// Helper: read a column name or bare literal, up to a blank, an operator or the end
+static char *read_word(const char **pp)
+{
+    const char *p = *pp, *start = p;
+    if (*p == '"')
+    {
+        const char *end = strchr(p + 1, '"');
+        if (!end) return NULL;
+        *pp = end + 1;
+        return strndup(p + 1, end - p - 1);
+    }
+    while (*p && *p != ' ' && *p != '\t' && !strchr("=!<>", *p)) p++;
+    if (p == start) return NULL;
+    *pp = p;
+    return strndup(start, p - start);
+}
+
+// Helper: read a comparison operator
+static int read_op(const char **pp, WhereOp *op)
+{
+    static const struct { const char *s; WhereOp op; } OPS[] = {
+        {"==", WHERE_EQ}, {"!=", WHERE_NE}, {"<>", WHERE_NE}, {"<=", WHERE_LE},
+        {">=", WHERE_GE}, {"=", WHERE_EQ}, {"<", WHERE_LT}, {">", WHERE_GT}
+    };
+    for (size_t i = 0; i < sizeof(OPS) / sizeof(OPS[0]); i++)
+    {
+        size_t n = strlen(OPS[i].s);
+        if (strncmp(*pp, OPS[i].s, n) == 0)
+        {
+            *op = OPS[i].op;
+            *pp += n;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Helper: true when p starts the connector word (followed by a blank)
+static int is_connector(const char *p, const char *word)
+{
+    size_t n = strlen(word);
+    return strncasecmp(p, word, n) == 0 && (p[n] == ' ' || p[n] == '\t');
+}
+
+// Helper: add a term, growing the array
+static int push_term(Where *w, const WhereTerm *t, int *cap)
+{
+    if (w->nterms == *cap)
+    {
+        int ncap = *cap ? *cap * 2 : 8;
+        WhereTerm *nt = realloc(w->terms, ncap * sizeof(WhereTerm));
+        int *ne = realloc(w->clauseEnd, ncap * sizeof(int));
+        if (nt) w->terms = nt;
+        if (ne) w->clauseEnd = ne;
+        if (!nt || !ne) return -1;
+        *cap = ncap;
+    }
+    w->terms[w->nterms++] = *t;
+    return 0;
+}
+
+// Parse a filter such as "year >= 2020 and role = manager or dept != \"r&d\"".
+// 'and' binds tighter than 'or'. A literal compares as a number when it is
+// one, otherwise as text without regard to case. Prints an error and
+// returns -1 on bad syntax.
+int where_parse(const char *expr, Where *w)
+{
+    memset(w, 0, sizeof(*w));
+    int cap = 0;
+    const char *p = skip_blanks(expr);
+    while (*p)
+    {
+        WhereTerm t = {0};
+        t.col = -1;
+        t.column = read_word(&p);
+        p = skip_blanks(p);
+        if (!t.column || !read_op(&p, &t.op))
+        {
+            out_printf("Error: bad where condition near '%s'. Use e.g. where='year >= 2020 and role = manager'\n", p);
+            free(t.column);
+            where_free(w);
+            return -1;
+        }
+        mathi_string_to_lower(t.column);
+        p = skip_blanks(p);
+        t.text = read_word(&p);
+        if (!t.text)
+        {
+            out_printf("Error: missing value after '%s' in where\n", t.column);
+            free(t.column);
+            where_free(w);
+            return -1;
+        }
+        t.isNumber = csv_number(t.text, &t.num);
+        if (push_term(w, &t, &cap) != 0)
+        {
+            out_printf("Error: out of memory\n");
+            free(t.column);
+            free(t.text);
+            where_free(w);
+            return -1;
+        }
+
+        p = skip_blanks(p);
+        if (is_connector(p, "and")) p = skip_blanks(p + 3);
+        else if (is_connector(p, "or"))
+        {
+            w->clauseEnd[w->nclauses++] = w->nterms;
+            p = skip_blanks(p + 2);
+        }
+        else if (*p)
+        {
+            out_printf("Error: expected 'and' or 'or' in where near '%s'\n", p);
+            where_free(w);
+            return -1;
+        }
+    }
+    if (w->nterms > 0) w->clauseEnd[w->nclauses++] = w->nterms;
+    return 0;
+}
+
+// Resolve column names to indexes; prints the missing column and returns -1
+int where_bind(Where *w, char **names, int ncols)
+{
+    for (int i = 0; i < w->nterms; i++)
+    {
+        WhereTerm *t = &w->terms[i];
+        t->col = -1;
+        for (int c = 0; c < ncols; c++)
+            if (strcmp(names[c], t->column) == 0) { t->col = c; break; }
+        if (t->col == -1)
+        {
+            out_printf("Error: where column not found -> %s\n", t->column);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Helper: apply the operator to a comparison result
+static int compare_holds(WhereOp op, int cmp)
+{
+    switch (op)
+    {
+        case WHERE_EQ: return cmp == 0;
+        case WHERE_NE: return cmp != 0;
+        case WHERE_LT: return cmp < 0;
+        case WHERE_LE: return cmp <= 0;
+        case WHERE_GT: return cmp > 0;
+        case WHERE_GE: return cmp >= 0;
+    }
+    return 0;
+}
+
+// Helper: test one term against a cell, as text and (when both are) as numbers
+static int term_holds(const WhereTerm *t, const char *cell, int haveNum, double num)
+{
+    if (t->isNumber)
+    {
+        if (!haveNum) return t->op == WHERE_NE;
+        return compare_holds(t->op, num < t->num ? -1 : num > t->num ? 1 : 0);
+    }
+    return compare_holds(t->op, strcasecmp(cell, t->text));
+}
+
+// True when the row given as CSV fields passes the filter
+int where_match(const Where *w, char **fields, int nfields)
+{
+    int start = 0;
+    for (int k = 0; k < w->nclauses; k++)
+    {
+        int ok = 1;
+        for (int i = start; ok && i < w->clauseEnd[k]; i++)
+        {
+            const WhereTerm *t = &w->terms[i];
+            const char *cell = t->col < nfields ? fields[t->col] : "";
+            double num = 0;
+            int haveNum = t->isNumber && csv_number(cell, &num);
+            ok = term_holds(t, cell, haveNum, num);
+        }
+        if (ok) return 1;
+        start = w->clauseEnd[k];
+    }
+    return w->nclauses == 0;
+}
+
+// Helper: test one term against a dataset cell
+static int term_holds_row(const WhereTerm *t, const Dataset *ds, long row)
+{
+    char buf[32];
+    double num = 0;
+    int haveNum = t->isNumber && dataset_number(ds, t->col, row, &num);
+    const char *cell = t->isNumber ? "" : dataset_text(ds, t->col, row, buf, sizeof(buf));
+    return term_holds(t, cell, haveNum, num);
+}
+
+// True when a dataset row passes the filter
+int where_match_row(const Where *w, const Dataset *ds, long row)
+{
+    int start = 0;
+    for (int k = 0; k < w->nclauses; k++)
+    {
+        int ok = 1;
+        for (int i = start; ok && i < w->clauseEnd[k]; i++) ok = term_holds_row(&w->terms[i], ds, row);
+        if (ok) return 1;
+        start = w->clauseEnd[k];
+    }
+    return w->nclauses == 0;
+}
+
+// Helper: the rows of an indexed column that pass a term. A term depends on
+// the cell's value alone, so it is tested once per distinct value, on a row
+// holding it, and the bitmaps of the values that pass are ORed. Returns 0,
+// -1 when out of memory.
+static int term_rows(const WhereTerm *t, const Dataset *ds, Bitmap *out)
+{
+    const ColumnIndex *idx = ds->cols[t->col].index;
+    memset(out, 0, sizeof(*out));
+    for (uint32_t i = 0; i < idx->nvalues; i++)
+    {
+        if (!term_holds_row(t, ds, idx->rowOf[i])) continue;
+        Bitmap u;
+        if (bitmap_or(out, &idx->rows[i], &u) != 0)
+        {
+            bitmap_free(out);
+            return -1;
+        }
+        bitmap_free(out);
+        *out = u;
+    }
+    return 0;
+}
+
+// Helper: the rows a clause (terms start to end) can match: its terms on
+// indexed columns ANDed; *exact is cleared when it has other terms. The
+// clause needs at least one indexed term. Returns 0, -1 when out of memory.
+static int clause_rows(const Where *w, const Dataset *ds, int start, int end, Bitmap *out, int *exact)
+{
+    int have = 0;
+    for (int i = start; i < end; i++)
+    {
+        const WhereTerm *t = &w->terms[i];
+        if (!ds->cols[t->col].index)
+        {
+            *exact = 0;
+            continue;
+        }
+        Bitmap rows, both;
+        if (term_rows(t, ds, &rows) != 0)
+        {
+            if (have) bitmap_free(out);
+            return -1;
+        }
+        if (!have)
+        {
+            *out = rows;
+            have = 1;
+            continue;
+        }
+        int rc = bitmap_and(out, &rows, &both);
+        bitmap_free(out);
+        bitmap_free(&rows);
+        if (rc != 0) return -1;
+        *out = both;
+    }
+    return 0;
+}
+
+// Helper: the rows the filter can match, from the indexes: each clause's
+// rows ORed. Terms on columns without an index are left out, so the rows
+// are then a superset (*exact 0). Returns 0, -1 when a clause has no
+// indexed term (every row could match) or when out of memory.
+static int where_rows(const Where *w, const Dataset *ds, Bitmap *out, int *exact)
+{
+    int start = 0;
+    for (int k = 0; k < w->nclauses; k++)
+    {
+        int any = 0;
+        for (int i = start; i < w->clauseEnd[k]; i++) any |= ds->cols[w->terms[i].col].index != NULL;
+        if (!any) return -1;
+        start = w->clauseEnd[k];
+    }
+
+    Bitmap all = {0};
+    *exact = 1;
+    start = 0;
+    for (int k = 0; k < w->nclauses; k++)
+    {
+        Bitmap clause, either;
+        if (clause_rows(w, ds, start, w->clauseEnd[k], &clause, exact) != 0)
+        {
+            bitmap_free(&all);
+            return -1;
+        }
+        start = w->clauseEnd[k];
+        int rc = bitmap_or(&all, &clause, &either);
+        bitmap_free(&clause);
+        bitmap_free(&all);
+        if (rc != 0) return -1;
+        all = either;
+    }
+    *out = all;
+    return 0;
+}
+
+// Start a walk over the rows of ds that pass w (bound to ds's columns)
+void where_scan_start(WhereScan *s, const Where *w, const Dataset *ds)
+{
+    memset(s, 0, sizeof(*s));
+    s->w = w;
+    s->ds = ds;
+    if (w->nclauses > 0 && where_rows(w, ds, &s->matches, &s->exact) == 0)
+    {
+        s->indexed = 1;
+        bitmap_iter(&s->it, &s->matches);
+    }
+}
+
+// The next row that passes the filter, -1 at the end or when cancelled
+long where_scan_next(WhereScan *s)
+{
+    while (1)
+    {
+        long r;
+        if (s->indexed) r = bitmap_next(&s->it);
+        else r = s->row < s->ds->nrows ? s->row++ : -1;
+        if (r < 0) return -1;
+        if (s->visited++ % CANCEL_CHECK_ROWS == 0 && cancel_requested()) return -1;
+        if (s->exact || where_match_row(s->w, s->ds, r)) return r;
+    }
+}
+
+// Release the walk's matches
+void where_scan_end(WhereScan *s)
+{
+    bitmap_free(&s->matches);
+}
+
+// Release a parsed filter
+void where_free(Where *w)
+{
+    for (int i = 0; i < w->nterms; i++)
+    {
+        free(w->terms[i].column);
+        free(w->terms[i].text);
+    }
+    free(w->terms);
+    free(w->clauseEnd);
+    memset(w, 0, sizeof(*w));
+}
@@ -0,0 +1,166 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../headers/mathigraphs.h"
+
+// Ring size a span window starts with; it doubles as the window fills
+#define WINDOW_START_CAP 64
+
+// Parse window=: a point count such as 30, or a span such as 90s, 15m, 12h,
+// 7d or 2w. Returns 1 on success.
+int window_parse(const char *spec, WindowSpec *w)
+{
+    memset(w, 0, sizeof(*w));
+    int n;
+    if (mathi_str_to_int(spec, &n) == 0)
+    {
+        w->count = n;
+        return n > 0;
+    }
+    return ts_bucket_width(spec, &w->span);
+}
+
+// Set up an empty window, 0 on success
+int rolling_init(Rolling *r, const WindowSpec *spec)
+{
+    memset(r, 0, sizeof(*r));
+    r->spec = *spec;
+    r->cap = spec->count > 0 ? spec->count : WINDOW_START_CAP;
+    r->ring = malloc(r->cap * sizeof(WindowEntry));
+    r->mins = malloc(r->cap * sizeof(WindowEntry));
+    r->maxs = malloc(r->cap * sizeof(WindowEntry));
+    if (!r->ring || !r->mins || !r->maxs)
+    {
+        rolling_free(r);
+        return -1;
+    }
+    return 0;
+}
+
+// Helper: copy a circular buffer into a new one of ncap entries, oldest first
+static WindowEntry *unwrap(const WindowEntry *buf, long cap, long head, long size, long ncap)
+{
+    WindowEntry *nb = malloc(ncap * sizeof(WindowEntry));
+    if (!nb) return NULL;
+    for (long i = 0; i < size; i++) nb[i] = buf[(head + i) % cap];
+    return nb;
+}
+
+// Helper: double the ring and both deques (span windows only)
+static int rolling_grow(Rolling *r)
+{
+    long ncap = r->cap * 2;
+    WindowEntry *ring = unwrap(r->ring, r->cap, r->head, r->size, ncap);
+    WindowEntry *mins = unwrap(r->mins, r->cap, r->minHead, r->minSize, ncap);
+    WindowEntry *maxs = unwrap(r->maxs, r->cap, r->maxHead, r->maxSize, ncap);
+    if (!ring || !mins || !maxs)
+    {
+        free(ring); free(mins); free(maxs);
+        return -1;
+    }
+    free(r->ring); free(r->mins); free(r->maxs);
+    r->ring = ring;
+    r->mins = mins;
+    r->maxs = maxs;
+    r->head = r->minHead = r->maxHead = 0;
+    r->cap = ncap;
+    return 0;
+}
+
+// Helper: drop the oldest entry. Once per ring length the sums are added up
+// again from the entries, so rounding from the subtractions cannot build up.
+static void rolling_evict(Rolling *r)
+{
+    const WindowEntry *old = &r->ring[r->head];
+    if (r->minSize > 0 && r->mins[r->minHead].seq == old->seq) { r->minHead = (r->minHead + 1) % r->cap; r->minSize--; }
+    if (r->maxSize > 0 && r->maxs[r->maxHead].seq == old->seq) { r->maxHead = (r->maxHead + 1) % r->cap; r->maxSize--; }
+    r->sum -= old->sum;
+    r->sumsq -= old->sumsq;
+    r->count -= old->count;
+    r->head = (r->head + 1) % r->cap;
+    r->size--;
+
+    if (++r->evicted < r->cap) return;
+    r->evicted = 0;
+    r->sum = r->sumsq = 0;
+    r->count = 0;
+    for (long i = 0; i < r->size; i++)
+    {
+        const WindowEntry *e = &r->ring[(r->head + i) % r->cap];
+        r->sum += e->sum;
+        r->sumsq += e->sumsq;
+        r->count += e->count;
+    }
+}
+
+// Add the newest point and let the oldest ones leave. Points are expected
+// in x order; a span window drops those at least span behind this one.
+// Returns -1 when out of memory.
+int rolling_push(Rolling *r, const WindowEntry *e)
+{
+    if (r->spec.count > 0)
+    {
+        if (r->size == r->spec.count) rolling_evict(r);
+    }
+    else
+    {
+        while (r->size > 0 && e->x - r->ring[r->head].x >= (double)r->spec.span) rolling_evict(r);
+        if (r->size == r->cap && rolling_grow(r) != 0) return -1;
+    }
+
+    WindowEntry in = *e;
+    in.seq = r->seq++;
+    r->ring[(r->head + r->size) % r->cap] = in;
+    r->size++;
+    r->sum += in.sum;
+    r->sumsq += in.sumsq;
+    r->count += in.count;
+
+    // entries the new one beats can never be the min (or max) again
+    while (r->minSize > 0 && r->mins[(r->minHead + r->minSize - 1) % r->cap].min >= in.min) r->minSize--;
+    r->mins[(r->minHead + r->minSize) % r->cap] = in;
+    r->minSize++;
+    while (r->maxSize > 0 && r->maxs[(r->maxHead + r->maxSize - 1) % r->cap].max <= in.max) r->maxSize--;
+    r->maxs[(r->maxHead + r->maxSize) % r->cap] = in;
+    r->maxSize++;
+    return 0;
+}
+
+// Smallest value in the window (after at least one push)
+double rolling_min(const Rolling *r)
+{
+    return r->mins[r->minHead].min;
+}
+
+// Largest value in the window (after at least one push)
+double rolling_max(const Rolling *r)
+{
+    return r->maxs[r->maxHead].max;
+}
+
+// The window's value for compute= (avg, the default, sum, max or min)
+double rolling_value(const Rolling *r, const char *compute)
+{
+    if (!compute || strcmp(compute, "avg") == 0) return r->sum / r->count;
+    if (strcmp(compute, "sum") == 0) return r->sum;
+    if (strcmp(compute, "max") == 0) return rolling_max(r);
+    return rolling_min(r);
+}
+
+// Empty the window for another pass over the same points
+void rolling_reset(Rolling *r)
+{
+    r->head = r->size = r->seq = r->evicted = 0;
+    r->sum = r->sumsq = 0;
+    r->count = 0;
+    r->minHead = r->minSize = r->maxHead = r->maxSize = 0;
+}
+
+// Release the buffers
+void rolling_free(Rolling *r)
+{
+    free(r->ring);
+    free(r->mins);
+    free(r->maxs);
+    memset(r, 0, sizeof(*r));
+}